@@ -0,0 +1,756 @@
+// Benchmark suite: times the game's hot paths and writes the results as JSON
+// so they can be compared across commits.
+//
+// Cases that need a GL context (model import) or the downloaded resources are
+// reported as skipped when those are not available.
+//
+// usage: bench [--out <file>] [--min-time <seconds>] [--filter <substring>]
+
+#include "header.h"
+#include "Model.h"
+#include "Projectile.h"
+#include "Procedural.h"
+#include "BVH.h"
+#include "JobSystem.h"
+#include "Transforms.h"
+#include "Frustum.h"
+#include "Particles.h"
+#include "Simulation.h"
+#include "Simplify.h"
+#include "MeshOptimize.h"
+#include "Text.h"
+#include "Random.h"
+#include "Headless.h"
+#include "stb_image.h"
+
+#include "../common/vboindexer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <sys/stat.h>
+
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+
+// keeps results observable so the optimizer can't drop the measured work
+volatile uint64_t benchSink = 0;
+
+struct BenchResult
+{
+    std::string name;
+    bool skipped = false;
+    bool failed = false; // a case that also checks a property found it broken
+    std::string reason;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    uint64_t itemsPerOp = 1; // e.g. projectiles per update, pairs per collision pass
+};
+
+struct BenchOptions
+{
+    std::string out = "bench_results.json";
+    double minTime = 0.5; // seconds per case
+    std::string filter;
+};
+
+// Discards std::cout while alive; the game logs hits and load errors there
+struct QuietStdout
+{
+    std::streambuf *saved;
+    QuietStdout() : saved(std::cout.rdbuf(nullptr)) {}
+    ~QuietStdout()
+    {
+        std::cout.rdbuf(saved);
+        std::cout.clear();
+    }
+};
+
+static bool fileExists(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// Run fn once to warm up, then repeat it in growing batches until minTime has elapsed
+static BenchResult runBench(const std::string &name, uint64_t itemsPerOp, double minTime, uint64_t maxIterations, const std::function<void()> &fn)
+{
+    using clock = std::chrono::steady_clock;
+    BenchResult result;
+    result.name = name;
+    result.itemsPerOp = itemsPerOp;
+
+    fn();
+
+    uint64_t batch = 1;
+    double elapsed = 0.0;
+    while (elapsed < minTime && result.iterations < maxIterations)
+    {
+        batch = std::min(batch, maxIterations - result.iterations);
+        auto start = clock::now();
+        for (uint64_t i = 0; i < batch; i++)
+            fn();
+        elapsed += std::chrono::duration<double>(clock::now() - start).count();
+        result.iterations += batch;
+        batch *= 2;
+    }
+    result.nsPerOp = elapsed * 1e9 / result.iterations;
+    return result;
+}
+
+static BenchResult skipped(const std::string &name, const std::string &reason)
+{
+    BenchResult result;
+    result.name = name;
+    result.skipped = true;
+    result.reason = reason;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// cases
+
+// 64 enemy boxes and 256 player bolts scattered over the play field, from one seed
+// so every collision case tests the same pairs
+struct CollisionScene
+{
+    std::vector<glm::vec3> enemyMin, enemyMax, boltMin, boltMax;
+};
+
+static CollisionScene makeCollisionScene()
+{
+    Random random(1);
+    const size_t enemyCount = 64, boltCount = 256;
+    CollisionScene scene;
+    for (size_t i = 0; i < enemyCount; i++)
+    {
+        glm::vec3 p(random.range(10.0f, 60.0f), 0.0f, random.range(-30.0f, 30.0f));
+        scene.enemyMin.push_back(p - glm::vec3(2.5f));
+        scene.enemyMax.push_back(p + glm::vec3(2.5f));
+    }
+    for (size_t i = 0; i < boltCount; i++)
+    {
+        glm::vec3 p(random.range(0.0f, 70.0f), 0.0f, random.range(-30.0f, 30.0f));
+        scene.boltMin.push_back(p - glm::vec3(0.1f, 0.5f, 0.1f));
+        scene.boltMax.push_back(p + glm::vec3(0.1f, 0.5f, 0.1f));
+    }
+    return scene;
+}
+
+static void addBolts(const CollisionScene &scene, BoxSet &bolts)
+{
+    for (size_t i = 0; i < scene.boltMin.size(); i++)
+        bolts.add(scene.boltMin[i], scene.boltMax[i]);
+}
+
+// The bolts swept by move over the tick
+static void addBolts(const CollisionScene &scene, SweptBoxSet &bolts, const glm::vec3 &move)
+{
+    for (size_t i = 0; i < scene.boltMin.size(); i++)
+        bolts.add(scene.boltMin[i], scene.boltMax[i], move);
+}
+
+static BenchResult benchCollision(const BenchOptions &options)
+{
+    // every player bolt against every enemy, as in Simulation::tick
+    CollisionScene scene = makeCollisionScene();
+    const size_t enemyCount = scene.enemyMin.size(), boltCount = scene.boltMin.size();
+
+    return runBench("collision_aabb_pairs", enemyCount * boltCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        uint64_t hits = 0;
+        for (size_t e = 0; e < enemyCount; e++)
+            for (size_t b = 0; b < boltCount; b++)
+                hits += checkCollision(scene.enemyMin[e], scene.enemyMax[e], scene.boltMin[b], scene.boltMax[b]);
+        benchSink += hits; });
+}
+
+static BenchResult benchCollisionSimd(const BenchOptions &options)
+{
+    // the same pairs as collision_aabb_pairs, each enemy against OVERLAP_BATCH bolts per overlapMask()
+    CollisionScene scene = makeCollisionScene();
+    const size_t enemyCount = scene.enemyMin.size(), boltCount = scene.boltMin.size();
+    BoxSet bolts;
+    addBolts(scene, bolts);
+
+    return runBench("collision_aabb_simd", enemyCount * boltCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        uint64_t hits = 0;
+        for (size_t e = 0; e < enemyCount; e++)
+            for (size_t first = 0; first < boltCount; first += OVERLAP_BATCH)
+                hits += static_cast<uint64_t>(__builtin_popcount(overlapMask(scene.enemyMin[e], scene.enemyMax[e], bolts, first)));
+        benchSink += hits; });
+}
+
+static BenchResult benchCollisionSwept(const BenchOptions &options)
+{
+    // collision_aabb_simd with every bolt swept over one 60 Hz tick of its 50 units/s move
+    CollisionScene scene = makeCollisionScene();
+    const size_t enemyCount = scene.enemyMin.size(), boltCount = scene.boltMin.size();
+    SweptBoxSet bolts;
+    addBolts(scene, bolts, glm::vec3(50.0f / 60.0f, 0.0f, 0.0f));
+
+    return runBench("collision_swept_simd", enemyCount * boltCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        uint64_t hits = 0;
+        for (size_t e = 0; e < enemyCount; e++)
+            for (size_t first = 0; first < boltCount; first += OVERLAP_BATCH)
+                hits += static_cast<uint64_t>(__builtin_popcount(sweptOverlapMask(scene.enemyMin[e], scene.enemyMax[e], bolts, first)));
+        benchSink += hits; });
+}
+
+static BenchResult benchProjectileUpdate(const BenchOptions &options)
+{
+    // the SoA kernel behind ProjectileList::update, on a million projectiles
+    Random random(2);
+    const size_t count = 1000000;
+    std::vector<float> x(count), y(count, 0.0f), z(count), vx(count), vy(count, 0.0f), vz(count), lifetime(count, 0.0f);
+    std::vector<uint8_t> expired(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = random.range(-50.0f, 50.0f);
+        z[i] = random.range(-50.0f, 50.0f);
+        vx[i] = random.range(-1.0f, 1.0f);
+        vz[i] = random.range(-1.0f, 1.0f);
+    }
+
+    return runBench("projectile_update", count, options.minTime, UINT64_MAX, [&]()
+                    {
+        benchSink += integrateProjectiles(x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), lifetime.data(), count,
+                                          1.0f / 60.0f, Projectile::maxDistance, Projectile::maxLifetime, expired.data()); });
+}
+
+static BenchResult benchParticleUpdate(const BenchOptions &options)
+{
+    // the CPU particle fallback at its full 100k budget, including the interleaved write for upload
+    Random random(6);
+    const size_t count = ParticleSystem::DEFAULT_CAPACITY;
+    ParticleSimulator simulator(count);
+    for (size_t i = 0; i < count; i++)
+        simulator.set(i, Particle{glm::vec3(random.range(-50.0f, 50.0f)), 0.0f, glm::vec3(random.range(-10.0f, 10.0f)), 1.0f, 0xFFFFFFFFu, 0.3f});
+    std::vector<Particle> out(count);
+
+    return runBench("particle_update_cpu", count, options.minTime, UINT64_MAX, [&]()
+                    {
+        simulator.update(1.0f / 60.0f, 0.97f, count, out.data());
+        benchSink += static_cast<uint64_t>(out[count / 2].age); });
+}
+
+static BenchResult benchTextLayout(const BenchOptions &options)
+{
+    // synthetic glyph metrics unless the font was loaded through a GL context
+    if (Characters.empty())
+    {
+        for (int c = 32; c < 128; c++)
+            Characters[static_cast<char>(c)] = Character{static_cast<unsigned int>(c), glm::ivec2(40, 48), glm::ivec2(4, 44), 48u << 6};
+    }
+
+    const std::string lines[] = {"Score: 123400", "Lives: 3", "Press Space to Restart", "Press ESC to Exit"};
+    std::vector<GlyphQuad> quads;
+    uint64_t glyphs = 0;
+    for (const auto &line : lines)
+        glyphs += line.size();
+
+    return runBench("text_layout", glyphs, options.minTime, UINT64_MAX, [&]()
+                    {
+        for (const auto &line : lines)
+        {
+            layoutText(line, 25.0f, 1030.0f, 1.0f, quads);
+            benchSink += quads.size();
+        } });
+}
+
+static BenchResult benchIndexVBO(const BenchOptions &options)
+{
+    // de-indexed triangle soup of the projectile cylinder, welded back by indexVBO
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    generateCylinder(1.0f, 0.1f, 256, vertices, indices);
+
+    std::vector<glm::vec3> inPositions, inNormals;
+    std::vector<glm::vec2> inUVs;
+    for (unsigned int index : indices)
+    {
+        inPositions.push_back(vertices[index].Position);
+        inNormals.push_back(vertices[index].Normal);
+        inUVs.push_back(vertices[index].TexCoords);
+    }
+
+    return runBench("index_vbo_weld", inPositions.size(), options.minTime, UINT64_MAX, [&]()
+                    {
+        std::vector<unsigned short> outIndices;
+        std::vector<glm::vec3> outPositions, outNormals;
+        std::vector<glm::vec2> outUVs;
+        indexVBO(inPositions, inUVs, inNormals, outIndices, outPositions, outUVs, outNormals);
+        benchSink += outPositions.size(); });
+}
+
+static BenchResult benchProceduralSphere(const BenchOptions &options)
+{
+    // a 64x32 sphere with 16-bit indices, regenerated into the same buffers
+    const GeometrySize size = sphereSize(64, 32, true);
+    std::vector<Vertex> vertices(size.vertexCount);
+    std::vector<uint16_t> indices(size.indexCount);
+
+    return runBench("procedural_sphere", size.vertexCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        generateSphere<uint16_t>(1.0f, 64, 32, true, vertices.data(), indices.data());
+        benchSink += indices[size.indexCount / 2]; });
+}
+
+// Static scenery standing in for the hangar: 128 spheres and boxes scattered over
+// 100 x 20 x 100 units, about 120k triangles
+static void addBvhScene(TriangleBVH &bvh)
+{
+    Random random(7);
+    std::vector<Vertex> sphereVertices, boxVertices;
+    std::vector<unsigned int> sphereIndices, boxIndices;
+    generateSphere(1.0f, 32, 16, sphereVertices, sphereIndices);
+    generateBox(glm::vec3(1.0f), boxVertices, boxIndices);
+    for (int i = 0; i < 128; i++)
+    {
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(random.range(-50.0f, 50.0f), random.range(-10.0f, 10.0f), random.range(-50.0f, 50.0f)));
+        transform = glm::scale(transform, glm::vec3(random.range(0.5f, 3.0f)));
+        bvh.addTriangles(sphereVertices, sphereIndices, transform);
+        bvh.addTriangles(boxVertices, boxIndices, glm::translate(transform, glm::vec3(2.0f, 0.0f, 0.0f)));
+    }
+}
+
+static BenchResult benchBvhBuild(const BenchOptions &options, const std::string &name, JobSystem *jobs)
+{
+    TriangleBVH scene;
+    addBvhScene(scene);
+    size_t triangles = scene.triangleCount();
+
+    return runBench(name, triangles, options.minTime, UINT64_MAX, [&]()
+                    {
+        TriangleBVH bvh;
+        addBvhScene(bvh);
+        bvh.build(jobs);
+        benchSink += bvh.nodeCount(); });
+}
+
+static BenchResult benchBvhRaycast(const BenchOptions &options)
+{
+    // rays from random points in the scene in random directions, up to 100 units
+    TriangleBVH bvh;
+    addBvhScene(bvh);
+    bvh.build();
+    Random random(8);
+    const size_t rayCount = 4096;
+    std::vector<glm::vec3> origins(rayCount), directions(rayCount);
+    for (size_t i = 0; i < rayCount; i++)
+    {
+        origins[i] = glm::vec3(random.range(-50.0f, 50.0f), random.range(-10.0f, 10.0f), random.range(-50.0f, 50.0f));
+        directions[i] = glm::normalize(glm::vec3(random.range(-1.0f, 1.0f), random.range(-1.0f, 1.0f), random.range(-1.0f, 1.0f)));
+    }
+
+    return runBench("bvh_raycast", rayCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        RayHit hit;
+        for (size_t i = 0; i < rayCount; i++)
+            benchSink += bvh.raycast(origins[i], directions[i], 100.0f, hit); });
+}
+
+static BenchResult benchBvhBoxQuery(const BenchOptions &options)
+{
+    // projectile-sized boxes (as in Simulation) tested against the scene
+    TriangleBVH bvh;
+    addBvhScene(bvh);
+    bvh.build();
+    Random random(9);
+    const size_t boxCount = 4096;
+    std::vector<glm::vec3> centers(boxCount);
+    for (size_t i = 0; i < boxCount; i++)
+        centers[i] = glm::vec3(random.range(-50.0f, 50.0f), random.range(-10.0f, 10.0f), random.range(-50.0f, 50.0f));
+
+    return runBench("bvh_box_query", boxCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        for (size_t i = 0; i < boxCount; i++)
+            benchSink += bvh.overlaps(centers[i] - glm::vec3(0.1f, 0.5f, 0.1f), centers[i] + glm::vec3(0.1f, 0.5f, 0.1f)); });
+}
+
+static BenchResult benchMeshSimplify(const BenchOptions &options)
+{
+    // simplified to a quarter of its triangles like a model LOD
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    generateSphere(1.0f, 128, 64, vertices, indices, true);
+
+    return runBench("mesh_simplify", indices.size() / 3, options.minTime, UINT64_MAX, [&]()
+                    {
+        std::vector<unsigned int> simplified = simplifyMesh(vertices, indices, indices.size() / 4);
+        benchSink += simplified.size(); });
+}
+
+static BenchResult benchMeshOptimize(const BenchOptions &options)
+{
+    // the import-time pass (cache, overdraw, fetch) on a sphere whose triangles arrive shuffled
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    generateSphere(1.0f, 128, 64, vertices, indices, true);
+    Random random(5);
+    for (size_t t = indices.size() / 3 - 1; t > 0; t--)
+    {
+        size_t other = random.below(static_cast<uint32_t>(t + 1));
+        for (int k = 0; k < 3; k++)
+            std::swap(indices[t * 3 + k], indices[other * 3 + k]);
+    }
+
+    return runBench("mesh_optimize", indices.size() / 3, options.minTime, UINT64_MAX, [&]()
+                    {
+        std::vector<Vertex> v = vertices;
+        std::vector<unsigned int> i = indices;
+        optimizeMesh(v, i);
+        benchSink += i[0]; });
+}
+
+static BenchResult benchTextureDecode(const BenchOptions &options)
+{
+    // decode from memory so disk speed doesn't enter the measurement
+    std::string path = "resources/skybox 2/right.png";
+    if (!fileExists(path))
+    {
+        // no resources: decode a generated 512x512 image instead
+        const int size = 512;
+        std::vector<unsigned char> pixels(size * size * 3);
+        for (size_t i = 0; i < pixels.size(); i++)
+            pixels[i] = static_cast<unsigned char>((i * 2654435761u) >> 24);
+        path = "bench_texture.png";
+        if (!writePNG(path, size, size, pixels))
+            return skipped("texture_decode_png", "cannot write " + path);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (path == "bench_texture.png")
+        std::remove(path.c_str());
+
+    int width = 0, height = 0, components = 0;
+    uint64_t pixelCount = 0;
+    if (stbi_info_from_memory(encoded.data(), static_cast<int>(encoded.size()), &width, &height, &components))
+        pixelCount = static_cast<uint64_t>(width) * height;
+
+    return runBench("texture_decode_png", pixelCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        int w, h, n;
+        unsigned char *data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &w, &h, &n, 0);
+        benchSink += data ? data[0] : 0;
+        stbi_image_free(data); });
+}
+
+static BenchResult benchModelImport(const BenchOptions &options, bool haveContext)
+{
+    const std::string path = "resources/invader1/invader.obj";
+    if (!haveContext)
+        return skipped("model_import", "no GL context");
+    if (!fileExists(path))
+        return skipped("model_import", "missing " + path);
+
+    // each import uploads new arena space and textures, so keep the count bounded
+    return runBench("model_import", 1, options.minTime, 64, [&]()
+                    {
+        Model::clearCache(); // time the import, not the cache hit
+        Model model(const_cast<char *>(path.c_str()));
+        benchSink += model.textures_loaded.size(); });
+}
+
+static BenchResult benchTransformBuild(const BenchOptions &options, const std::string &name, JobSystem *jobs)
+{
+    // world matrices of a 100k-entity scene with the invader orientation, written
+    // into interleaved instance data as the render queue's instance runs do
+    const size_t count = 100000;
+    Random random(9);
+    std::vector<glm::vec3> positions(count);
+    std::vector<InstanceData> instances(count);
+    for (size_t i = 0; i < count; i++)
+        positions[i] = glm::vec3(random.range(-100.0f, 100.0f), 0.0f, random.range(-100.0f, 100.0f));
+    glm::mat4 orientation = glm::scale(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.6f));
+
+    return runBench(name, count, options.minTime, UINT64_MAX, [&]()
+                    {
+        buildTransforms(positions.data(), nullptr, count, orientation, &instances[0].model, sizeof(InstanceData), jobs);
+        benchSink += static_cast<uint64_t>(instances[count - 1].model[3][0]); });
+}
+
+static BenchResult benchJobDispatch(const BenchOptions &options)
+{
+    // overhead of the job system itself: jobs that do almost nothing, one per item
+    const size_t jobCount = 4096;
+    std::vector<uint32_t> values(jobCount);
+    return runBench("job_dispatch", jobCount, options.minTime, UINT64_MAX, [&]()
+                    {
+        jobSystem.parallelFor(jobCount, 1, [&](size_t begin, size_t end)
+                              {
+            for (size_t i = begin; i < end; i++)
+                values[i] += static_cast<uint32_t>(i); });
+        benchSink += values[jobCount - 1]; });
+}
+
+static BenchResult benchParallelForBesideJob(const BenchOptions &options)
+{
+    // A long job (a frame's simulation ticks) is queued from this thread while it is
+    // inside a parallelFor (the transforms). It is then the newest job on the queue
+    // this thread takes from, yet waiting for the parallelFor must leave it to the
+    // workers. Fails if this thread ran it before the parallelFor returned.
+    using clock = std::chrono::steady_clock;
+    const size_t count = 64 * 1024;
+    std::vector<float> values(count, 1.0f);
+    std::thread::id self = std::this_thread::get_id();
+    bool ranHere = false;
+
+    BenchResult result = runBench("parallel_for_beside_job", count, options.minTime, UINT64_MAX, [&]()
+                                  {
+        std::atomic<bool> released{false};
+        std::atomic<bool> queued{false};
+        JobCounter longJob;
+        auto tick = [&]()
+        {
+            // runs until the parallelFor is over (bounded, in case it is this thread's)
+            if (std::this_thread::get_id() == self && !released.load())
+                ranHere = true;
+            auto start = clock::now();
+            while (!released.load() && clock::now() - start < std::chrono::milliseconds(100))
+                std::this_thread::yield();
+        };
+
+        jobSystem.parallelFor(count, 4096, [&](size_t begin, size_t end)
+                              {
+            if (std::this_thread::get_id() == self && !queued.exchange(true))
+                jobSystem.run(longJob, tick);
+            for (size_t i = begin; i < end; i++)
+                values[i] = values[i] * 0.5f + 1.0f; });
+        released.store(true);
+        jobSystem.wait(longJob);
+        benchSink += static_cast<uint64_t>(values[count - 1]); });
+
+    if (ranHere)
+    {
+        result.failed = true;
+        result.reason = "the waiting thread ran the long job during parallelFor";
+    }
+    return result;
+}
+
+static BenchResult benchSimulationTick(const BenchOptions &options)
+{
+    QuietStdout quiet;
+    Simulation pristine;
+    pristine.enemyFireRandom.reseed(3, RANDOM_STREAM_ENEMY_FIRE);
+    pristine.reset(createFormationSlots(glm::vec3(55.0f, 0.0f, 0.0f), 3, 6, 7.0f, 12.0f));
+
+    Simulation simulation = pristine;
+    uint64_t tick = 0;
+    return runBench("simulation_tick", 1, options.minTime, UINT64_MAX, [&]()
+                    {
+        // the player taps fire about twice a second (just over the cooldown) while
+        // strafing; restart whenever the round ends
+        FighterInput input;
+        input.fire = tick % 32 == 0;
+        input.right = tick % 240 < 120;
+        input.left = !input.right;
+        input.cameraPreset = 2;
+        tick++;
+        SimulationEvents events = simulation.tick(1.0f / 60.0f, input);
+        benchSink += events.enemiesDestroyed;
+        if (simulation.gameOver || simulation.formation.empty())
+            simulation = pristine; });
+}
+
+static BenchResult benchEnemyFrame(const BenchOptions &options)
+{
+    // the per-frame enemy work of the render loop for a 320x320-slot wave with every
+    // third invader shot down: snapshot, positions between ticks, culling, sorting into
+    // levels of detail and the instance data the flush writes for the visible ones
+    QuietStdout quiet;
+    Simulation simulation;
+    simulation.reset(createFormationSlots(glm::vec3(55.0f, 0.0f, 0.0f), 320, 320, 7.0f, 12.0f));
+    for (size_t slot = 0; slot < simulation.formation.slotCount(); slot += 3)
+        simulation.formation.kill(slot);
+    simulation.formation.previousOffset = simulation.formation.offset - glm::vec3(0.0f, 0.0f, 0.04f);
+
+    glm::mat4 orientation = glm::scale(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.6f));
+    BoundingSphere bounds;
+    bounds.radius = 2.5f;
+    glm::vec3 eye = glm::vec3(-10.0f, 5.0f, 0.0f);
+    Frustum frustum(glm::perspective(glm::radians(45.0f), 1920.0f / 1080.0f, 0.1f, 1000.0f) *
+                    glm::lookAt(eye, glm::vec3(55.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    const float lodDistances[] = {0.0f, 40.0f * 40.0f, 80.0f * 80.0f, 160.0f * 160.0f};
+    const size_t lodCount = sizeof(lodDistances) / sizeof(lodDistances[0]);
+
+    SimulationSnapshot snapshot;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> byLod[lodCount];
+    std::vector<InstanceData> instances;
+    CullBatch cullBatch;
+    return runBench("enemy_frame", simulation.formation.aliveCount(), options.minTime, UINT64_MAX, [&]()
+                    {
+        simulation.takeSnapshot(snapshot);
+        size_t count = snapshot.enemyPositions.size();
+        positions.resize(count);
+        for (size_t e = 0; e < count; e++)
+            positions[e] = glm::mix(snapshot.enemyPrevious[e], snapshot.enemyPositions[e], 0.5f);
+
+        cullBatch.clear();
+        cullBatch.add(bounds, positions.data(), count);
+        cullBatch.cull(frustum);
+
+        for (std::vector<uint32_t> &enemies : byLod)
+            enemies.clear();
+        for (size_t e = 0; e < count; e++)
+        {
+            if (cullBatch.isVisible(e))
+            {
+                glm::vec3 offset = positions[e] - eye;
+                float distanceSquared = glm::dot(offset, offset);
+                size_t lod = 0;
+                while (lod + 1 < lodCount && distanceSquared >= lodDistances[lod + 1])
+                    lod++;
+                byLod[lod].push_back(static_cast<uint32_t>(e));
+            }
+        }
+
+        instances.resize(cullBatch.visibleCount());
+        size_t first = 0;
+        for (const std::vector<uint32_t> &enemies : byLod)
+        {
+            buildTransforms(positions.data(), enemies.data(), enemies.size(), orientation, &(instances.data() + first)->model, sizeof(InstanceData), nullptr);
+            first += enemies.size();
+        }
+        benchSink += cullBatch.visibleCount(); });
+}
+
+// ---------------------------------------------------------------------------
+
+static std::string jsonEscape(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static bool writeResults(const std::string &path, const std::vector<BenchResult> &results)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cerr << "Error: Unable to write benchmark results: " << path << std::endl;
+        return false;
+    }
+
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n";
+    out << "  \"commit\": \"" << jsonEscape(BENCH_COMMIT) << "\",\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", ";
+        if (r.skipped)
+        {
+            out << "\"skipped\": true, \"reason\": \"" << jsonEscape(r.reason) << "\"}";
+        }
+        else
+        {
+            if (r.failed)
+                out << "\"failed\": true, \"reason\": \"" << jsonEscape(r.reason) << "\", ";
+            out << "\"skipped\": false, \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"items_per_op\": " << r.itemsPerOp
+                << ", \"ns_per_item\": " << r.nsPerOp / r.itemsPerOp << "}";
+        }
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && hasValue)
+            options.out = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+            options.minTime = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+            options.filter = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--out <file>] [--min-time <seconds>] [--filter <substring>]" << std::endl;
+            return -1;
+        }
+    }
+
+    // a small offscreen context for the cases that upload to the GPU
+    HeadlessSession context(0, "", 1, "");
+    bool haveContext = context.init(64, 64);
+
+    // workers for the parallel cases
+    jobSystem.start();
+
+    std::vector<std::pair<std::string, std::function<BenchResult()>>> cases = {
+        {"model_import", [&]() { return benchModelImport(options, haveContext); }},
+        {"texture_decode_png", [&]() { return benchTextureDecode(options); }},
+        {"index_vbo_weld", [&]() { return benchIndexVBO(options); }},
+        {"procedural_sphere", [&]() { return benchProceduralSphere(options); }},
+        {"mesh_simplify", [&]() { return benchMeshSimplify(options); }},
+        {"bvh_build", [&]() { return benchBvhBuild(options, "bvh_build", nullptr); }},
+        {"bvh_build_parallel", [&]() { return benchBvhBuild(options, "bvh_build_parallel", &jobSystem); }},
+        {"bvh_raycast", [&]() { return benchBvhRaycast(options); }},
+        {"bvh_box_query", [&]() { return benchBvhBoxQuery(options); }},
+        {"mesh_optimize", [&]() { return benchMeshOptimize(options); }},
+        {"collision_aabb_pairs", [&]() { return benchCollision(options); }},
+        {"collision_aabb_simd", [&]() { return benchCollisionSimd(options); }},
+        {"collision_swept_simd", [&]() { return benchCollisionSwept(options); }},
+        {"projectile_update", [&]() { return benchProjectileUpdate(options); }},
+        {"particle_update_cpu", [&]() { return benchParticleUpdate(options); }},
+        {"text_layout", [&]() { return benchTextLayout(options); }},
+        {"job_dispatch", [&]() { return benchJobDispatch(options); }},
+        {"parallel_for_beside_job", [&]() { return benchParallelForBesideJob(options); }},
+        {"transform_build", [&]() { return benchTransformBuild(options, "transform_build", nullptr); }},
+        {"transform_build_parallel", [&]() { return benchTransformBuild(options, "transform_build_parallel", &jobSystem); }},
+        {"simulation_tick", [&]() { return benchSimulationTick(options); }},
+        {"enemy_frame", [&]() { return benchEnemyFrame(options); }},
+    };
+
+    std::vector<BenchResult> results;
+    bool anyFailed = false;
+    for (auto &entry : cases)
+    {
+        if (!options.filter.empty() && entry.first.find(options.filter) == std::string::npos)
+            continue;
+
+        BenchResult r = entry.second();
+        anyFailed |= r.failed;
+        if (r.skipped)
+            std::printf("%-24s skipped (%s)\n", r.name.c_str(), r.reason.c_str());
+        else if (r.failed)
+            std::printf("%-24s FAILED (%s)\n", r.name.c_str(), r.reason.c_str());
+        else
+            std::printf("%-24s %12.1f ns/op %10.3f ns/item %10llu iterations\n", r.name.c_str(), r.nsPerOp,
+                        r.nsPerOp / r.itemsPerOp, static_cast<unsigned long long>(r.iterations));
+        results.push_back(r);
+    }
+
+    if (haveContext)
+        context.destroy();
+
+    return writeResults(options.out, results) && !anyFailed ? 0 : -1;
+}
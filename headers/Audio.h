@@ -0,0 +1,14 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+// Music and sound effects (SFML stays inside src/Audio.cpp)
+
+// Load the theme music and sound effects and start the music
+bool initializeAudio();
+
+void cleanupAudio();
+
+void playShootSound();
+void playExplosionSound();
+
+#endif // AUDIO_H
@@ -0,0 +1,90 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "header.h"
+#include "Bounds.h"
+#include "Mesh.h"
+#include "JobSystem.h"
+
+#include <cstdint>
+
+class Model;
+
+// One node of the flattened hierarchy, 32 bytes so two share a cache line.
+// Nodes are stored depth first: an inner node's first child is the next node.
+struct BVHNode
+{
+    glm::vec3 min;
+    uint32_t offset; // leaf: first triangle; inner node: index of the second child
+    glm::vec3 max;
+    uint32_t count; // triangles in a leaf, 0 for an inner node
+
+    bool isLeaf() const { return count != 0; }
+};
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode should stay half a cache line");
+
+struct BVHTriangle
+{
+    glm::vec3 a, b, c;
+};
+
+struct RayHit
+{
+    float distance = 0.0f; // along the ray, in multiples of its direction
+    uint32_t triangle = 0; // in the order the triangles were added
+    glm::vec3 normal;      // unit geometric normal of the triangle (winding order, not facing the ray)
+};
+
+// Bounding volume hierarchy over static triangles (scenery such as the hangar),
+// for ray and box queries against far more triangles than could be tested one
+// by one. Add the geometry, call build() once at load time, then query.
+//
+// The build uses the surface area heuristic over binned centroids. The top of
+// the tree is split on the calling thread; the subtrees below it are built as
+// jobs and stitched into one depth-first node array, which is the same
+// whatever the number of threads.
+class TriangleBVH
+{
+public:
+    // Add triangles, transformed into the space the queries will use
+    void addTriangles(const vector<Vertex> &vertices, const vector<unsigned int> &indices, const glm::mat4 &transform = glm::mat4(1.0f));
+    void addMesh(const Mesh &mesh, const glm::mat4 &transform = glm::mat4(1.0f));
+    void addModel(const Model &model, const glm::mat4 &transform);
+
+    // Build the hierarchy over everything added so far, with the subtrees spread
+    // over jobs (null builds everything on the calling thread)
+    void build(JobSystem *jobs = &jobSystem);
+
+    void clear();
+
+    // Nearest triangle hit by origin + t * direction with 0 <= t <= maxDistance.
+    // Both sides of a triangle count.
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, RayHit &hit) const;
+
+    // Whether any triangle intersects the box
+    bool overlaps(const glm::vec3 &min, const glm::vec3 &max) const;
+
+    // Append the triangles intersecting the box (in the order they were added); returns how many
+    size_t queryBox(const glm::vec3 &min, const glm::vec3 &max, vector<uint32_t> &triangles) const;
+
+    size_t triangleCount() const { return triangles.empty() ? input.size() : triangles.size(); }
+    size_t nodeCount() const { return nodes.size(); }
+    const vector<BVHNode> &getNodes() const { return nodes; }
+    BoundingBox bounds() const;
+
+private:
+    vector<BVHTriangle> input; // as added, until build()
+
+    vector<BVHNode> nodes;
+    vector<BVHTriangle> triangles; // in leaf order
+    vector<uint32_t> triangleIds;  // index of triangles[i] as added
+
+    template <typename Visit>
+    bool visitBox(const glm::vec3 &min, const glm::vec3 &max, Visit visit) const;
+};
+
+// Exact triangle-box test (separating axes)
+bool triangleOverlapsBox(const BVHTriangle &triangle, const glm::vec3 &min, const glm::vec3 &max);
+
+#endif // BVH_H
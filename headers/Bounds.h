@@ -0,0 +1,34 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "header.h"
+
+// Axis-aligned box; empty() until something is added
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    bool empty() const { return min.x > max.x; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+
+    void merge(const BoundingBox &other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// Box around the 8 corners of box under the transform M (Arvo's method)
+BoundingBox transformBox(const BoundingBox &box, const glm::mat4 &M);
+
+// Sphere in the space of M for a sphere given before it (the radius grows with the largest axis scale)
+BoundingSphere transformSphere(const BoundingSphere &sphere, const glm::mat4 &M);
+
+#endif // BOUNDS_H
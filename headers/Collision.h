@@ -0,0 +1,65 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "header.h"
+
+#include <cstdint>
+
+inline bool checkCollision(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &minB, const glm::vec3 &maxB)
+{
+    return (minA.x <= maxB.x && maxA.x >= minB.x) &&
+           (minA.y <= maxB.y && maxA.y >= minB.y) &&
+           (minA.z <= maxB.z && maxA.z >= minB.z);
+}
+
+// Axis-aligned boxes stored as structure of arrays, so one box can be tested
+// against many of them with overlapMask()
+struct BoxSet
+{
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    size_t size() const { return minX.size(); }
+    void clear();
+    void add(const glm::vec3 &min, const glm::vec3 &max);
+    void remove(size_t index);
+};
+
+// Boxes tested by one overlapMask() call (one bit each)
+const size_t OVERLAP_BATCH = 16;
+
+// Bit i is set when boxes[first + i] overlaps (min, max), with the same rules as
+// checkCollision (touching counts). Tests OVERLAP_BATCH boxes, or those left
+// from first to the end of the set; 8 (AVX) or 4 (SSE) per compare where available.
+uint32_t overlapMask(const glm::vec3 &min, const glm::vec3 &max, const BoxSet &boxes, size_t first);
+
+// Boxes moving in a straight line: box i starts at start's box i and moves by
+// its displacement over the step being tested. The displacement is kept as its
+// per-axis reciprocal (infinite on axes it does not move along), so the sweep
+// multiplies instead of dividing.
+struct SweptBoxSet
+{
+    BoxSet start;
+    std::vector<float> inverseDx, inverseDy, inverseDz;
+
+    size_t size() const { return start.size(); }
+    void clear();
+    void add(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &displacement);
+    void remove(size_t index);
+};
+
+// Whether box A, moving by displacement, touches the still box B anywhere along
+// the way (slab test on the time intervals of overlap per axis; touching counts)
+bool checkSweptCollision(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &displacement,
+                         const glm::vec3 &minB, const glm::vec3 &maxB);
+
+// overlapMask for moving boxes: bit i is set when boxes[first + i] touches the
+// still box (min, max) at any point of its move, as in checkSweptCollision
+uint32_t sweptOverlapMask(const glm::vec3 &min, const glm::vec3 &max, const SweptBoxSet &boxes, size_t first);
+
+// Index of the lowest set bit of a non-zero mask
+inline unsigned int lowestBit(uint32_t mask)
+{
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+}
+
+#endif // COLLISION_H
@@ -0,0 +1,111 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Runtime options, filled from the command line
+struct Config
+{
+    uint64_t seed = 0x5EED5EEDull; // seed for every subsystem's Random
+
+    // headless mode: render offscreen for a fixed number of frames (for CI)
+    bool headless = false;
+    unsigned int frames = 600;      // frames to run in headless mode
+    std::string captureDir;         // write PNG captures here (empty = none)
+    unsigned int captureEvery = 60; // capture every Nth frame
+    std::string frameLog;           // write per-frame times as CSV here (empty = none)
+
+    bool showStats = false;     // start with the render stats overlay visible
+    bool noIndirect = false;    // submit draw by draw even when multi-draw indirect is available
+    bool noLod = false;         // always draw models at full detail
+    bool floatVertices = false; // keep model vertices as 32-byte floats instead of packing them
+    bool cpuParticles = false;  // simulate particles on the CPU instead of with transform feedback
+    double tickRate = 120.0;    // simulation ticks per second, independent of the frame rate
+};
+
+// Parse command line options:
+//   --seed <n>            seed used for enemy fire and camera shake (decimal or 0x hex)
+//   --headless            render offscreen with scripted input, no window or audio
+//   --frames <n>          number of frames to run in headless mode
+//   --capture <dir>       write a PNG of every Nth headless frame into dir
+//   --capture-every <n>   capture interval in frames
+//   --frame-log <file>    write headless frame times and render counters as CSV
+//   --stats               show the draw-call / state-change overlay (toggle with F3)
+//   --no-indirect         do not use multi-draw indirect submission
+//   --no-lod              draw every model at full detail
+//   --float-vertices      do not quantize model vertices
+//   --cpu-particles       simulate particles on the CPU (SSE) and upload them every frame
+//   --tick-rate <hz>      fixed simulation rate (frames are drawn interpolated between ticks)
+inline bool parseConfig(int argc, char **argv, Config &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            config.seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            config.headless = true;
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            config.frames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--capture") == 0 && hasValue)
+        {
+            config.captureDir = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--capture-every") == 0 && hasValue)
+        {
+            config.captureEvery = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--frame-log") == 0 && hasValue)
+        {
+            config.frameLog = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0)
+        {
+            config.showStats = true;
+        }
+        else if (std::strcmp(argv[i], "--no-indirect") == 0)
+        {
+            config.noIndirect = true;
+        }
+        else if (std::strcmp(argv[i], "--no-lod") == 0)
+        {
+            config.noLod = true;
+        }
+        else if (std::strcmp(argv[i], "--float-vertices") == 0)
+        {
+            config.floatVertices = true;
+        }
+        else if (std::strcmp(argv[i], "--cpu-particles") == 0)
+        {
+            config.cpuParticles = true;
+        }
+        else if (std::strcmp(argv[i], "--tick-rate") == 0 && hasValue)
+        {
+            config.tickRate = std::strtod(argv[++i], nullptr);
+            if (!(config.tickRate > 0.0))
+            {
+                std::cerr << "--tick-rate must be positive" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--seed <n>] [--headless] [--frames <n>] [--capture <dir>] [--capture-every <n>] [--frame-log <file>] [--stats] [--no-indirect] [--no-lod] [--float-vertices] [--cpu-particles] [--tick-rate <hz>]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // CONFIG_H
@@ -2,62 +2,24 @@
 #define ENEMY_H
 
 #include "Model.h"
-#include <tuple>
 
+// The invader model with its drawing orientation; where invaders are lives in the
+// Simulation's Formation, and all of them are drawn from one of these
 class Enemy : public Model
 {
 public:
     // Constructor
-    Enemy(const std::string &path, std::tuple<float, float, float> initialPos)
-        : Model(const_cast<char *>(path.c_str())), initialPosition(initialPos)
+    explicit Enemy(const std::string &path)
+        : Model(const_cast<char *>(path.c_str()))
     {
-        position = initialPosition;
+        setOrientation(glm::scale(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(2.6f)));
+        if (orientedBox.empty())
+        {
+            // no geometry (model missing or loaded without a GL context): fall back to a 5-unit cube
+            orientedBox.min = glm::vec3(-2.5f);
+            orientedBox.max = glm::vec3(2.5f);
+        }
     }
-
-    // Move horizontally by deltaX
-    void moveHorizontally(float deltaX)
-    {
-        std::tuple<float, float, float> newPos = std::make_tuple(
-            std::get<0>(position),
-            std::get<1>(position),
-            std::get<2>(position) + deltaX);
-        modelMove(newPos);
-    }
-
-    // Move down by deltaY
-    void moveDown(float deltaY)
-    {
-        std::tuple<float, float, float> newPos = std::make_tuple(
-            std::get<0>(position) - deltaY,
-            std::get<1>(position),
-            std::get<2>(position));
-        modelMove(newPos);
-    }
-
-    // Get current x position (now returns z coordinate)
-    float getX() const { return std::get<2>(position); }
-
-    // Get current y position (now returns y coordinate)
-    float getY() const { return std::get<0>(position); }
-
-    glm::vec3 getBoundingBoxMin() const
-    {
-        return glm::vec3(
-            std::get<0>(position) - 2.5f, // Adjust size as needed
-            std::get<1>(position) - 2.5f,
-            std::get<2>(position) - 2.5f);
-    }
-
-    glm::vec3 getBoundingBoxMax() const
-    {
-        return glm::vec3(
-            std::get<0>(position) + 2.5f, // Adjust size as needed
-            std::get<1>(position) + 2.5f,
-            std::get<2>(position) + 2.5f);
-    }
-
-private:
-    std::tuple<float, float, float> initialPosition;
 };
 
 #endif // ENEMY_H
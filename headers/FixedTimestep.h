@@ -0,0 +1,66 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <algorithm>
+
+// Turns variable frame times into a whole number of fixed simulation ticks.
+// Time not yet worth a tick is carried into the next frame, and alpha() says
+// how far the frame lies between the last two ticks, so drawing can
+// interpolate between them.
+class FixedTimestep
+{
+public:
+    // longest frame simulated in full; after a longer hitch the game slows down
+    // instead of running ever more ticks to catch up
+    static constexpr double maxFrameTime = 0.25;
+
+    explicit FixedTimestep(double ticksPerSecond = 120.0)
+    {
+        setRate(ticksPerSecond);
+    }
+
+    void setRate(double ticksPerSecond)
+    {
+        step = 1.0 / std::max(ticksPerSecond, 1.0);
+        accumulator = 0.0;
+    }
+
+    // Seconds covered by one tick
+    float tickTime() const
+    {
+        return static_cast<float>(step);
+    }
+
+    // Add a frame's elapsed time and return how many ticks to run for it
+    unsigned int advance(double frameTime)
+    {
+        accumulator += std::min(std::max(frameTime, 0.0), maxFrameTime);
+
+        // a tick due within a thousandth of a step counts as due, so rounding in the
+        // frame times cannot turn an even 2 + 2 ticks into 1 + 3
+        unsigned int ticks = 0;
+        while (accumulator >= step * 0.999)
+        {
+            accumulator -= step;
+            ticks++;
+        }
+        return ticks;
+    }
+
+    // Fraction of a tick between the last tick and the frame being drawn, in [0, 1]
+    float alpha() const
+    {
+        return static_cast<float>(std::min(std::max(accumulator / step, 0.0), 1.0));
+    }
+
+    void reset()
+    {
+        accumulator = 0.0;
+    }
+
+private:
+    double step = 1.0 / 120.0;
+    double accumulator = 0.0;
+};
+
+#endif // FIXED_TIMESTEP_H
@@ -0,0 +1,62 @@
+#ifndef FORMATION_H
+#define FORMATION_H
+
+#include "header.h"
+
+#include <cstdint>
+
+// The invader wave: every enemy has a slot in a grid, and the whole grid moves
+// together by one offset, so moving the wave costs the same however many enemies
+// it has. Enemy positions (slot + offset) are resolved only where they are
+// needed: collisions, enemy fire and drawing. Which slots are still alive is
+// kept as bits, 64 per word, so loops skip the dead ones a word at a time.
+class Formation
+{
+public:
+    glm::vec3 offset = glm::vec3(0.0f);         // added to every slot
+    glm::vec3 previousOffset = glm::vec3(0.0f); // before the last tick, for drawing between ticks
+
+    // Fill every slot with a live enemy and clear the offset
+    void reset(std::vector<glm::vec3> newSlots);
+
+    size_t slotCount() const { return slots.size(); }
+    size_t aliveCount() const { return alive; }
+    bool empty() const { return alive == 0; }
+
+    bool isAlive(size_t slot) const { return (aliveBits[slot / 64] >> (slot % 64)) & 1; }
+    void kill(size_t slot);
+
+    glm::vec3 getSlot(size_t slot) const { return slots[slot]; }
+    glm::vec3 getPosition(size_t slot) const { return slots[slot] + offset; }
+    glm::vec3 getPreviousPosition(size_t slot) const { return slots[slot] + previousOffset; }
+
+    // Extent of the slots (alive or not), relative to the offset
+    glm::vec3 slotMin() const { return minSlot; }
+    glm::vec3 slotMax() const { return maxSlot; }
+
+    // Slot of the nth live enemy, in slot order (n < aliveCount())
+    size_t nthAlive(size_t n) const;
+
+    // Call visit(slot) for every live enemy, in slot order
+    template <typename Visit>
+    void forEachAlive(Visit visit) const
+    {
+        for (size_t word = 0; word < aliveBits.size(); word++)
+        {
+            for (uint64_t bits = aliveBits[word]; bits != 0; bits &= bits - 1)
+                visit(word * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+        }
+    }
+
+private:
+    std::vector<glm::vec3> slots;
+    std::vector<uint64_t> aliveBits;
+    size_t alive = 0;
+    glm::vec3 minSlot = glm::vec3(0.0f), maxSlot = glm::vec3(0.0f);
+};
+
+// Slots of a rows x cols grid centred on center: columns spaced colSpacing apart
+// along x, rows rowSpacing apart along z, row by row
+std::vector<glm::vec3> createFormationSlots(const glm::vec3 &center, int rows, int cols, float rowSpacing, float colSpacing);
+
+#endif // FORMATION_H
@@ -0,0 +1,45 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "header.h"
+#include "Bounds.h"
+
+#include <cstdint>
+
+// The six planes of a view frustum, extracted from projection * view.
+// A point p is inside plane i when nx*p.x + ny*p.y + nz*p.z + d >= 0.
+// Stored as structure of arrays so one SIMD lane handles one sphere.
+struct Frustum
+{
+    float nx[6], ny[6], nz[6], d[6];
+
+    explicit Frustum(const glm::mat4 &viewProjection);
+};
+
+// World-space bounding spheres gathered for one batched frustum test
+class CullBatch
+{
+public:
+    void clear();
+
+    // Returns the index to query with isVisible() after cull()
+    size_t add(const BoundingSphere &sphere);
+
+    // Add count copies of a model-space sphere, moved to each of the positions;
+    // returns the index of the first
+    size_t add(const BoundingSphere &sphere, const glm::vec3 *positions, size_t count);
+
+    // Test every sphere against the frustum, 4 at a time with SSE where available
+    void cull(const Frustum &frustum);
+
+    bool isVisible(size_t index) const { return visible[index] != 0; }
+    size_t size() const { return x.size(); }
+    unsigned int visibleCount() const { return visibleTotal; }
+
+private:
+    std::vector<float> x, y, z, radius;
+    std::vector<uint8_t> visible;
+    unsigned int visibleTotal = 0;
+};
+
+#endif // FRUSTUM_H
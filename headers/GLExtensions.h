@@ -0,0 +1,23 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+// glad is generated for GL 4.1 (the macOS limit). Newer entry points are
+// loaded here when the context provides them, either by version or extension.
+
+typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+struct GLExtensions
+{
+    // glMultiDrawElementsIndirect honouring baseInstance (GL 4.3, or ARB_multi_draw_indirect + ARB_base_instance)
+    bool multiDrawIndirect = false;
+    MultiDrawElementsIndirectProc MultiDrawElementsIndirect = nullptr;
+};
+
+extern GLExtensions glExtensions;
+
+// Call right after gladLoadGLLoader, with the same loader
+void loadGLExtensions(GLADloadproc load);
+
+#endif // GL_EXTENSIONS_H
@@ -0,0 +1,62 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include "header.h"
+#include "RenderStats.h"
+
+// Shadow copy of the GL state the game touches. Every setter compares the
+// request against the cached value and only calls into GL when it differs,
+// counting both the issued and the skipped changes.
+//
+// All binds of programs, VAOs and textures must go through glState; after code
+// that changes them behind its back, call invalidate().
+class GLStateCache
+{
+public:
+    RenderStats frame;     // counters of the frame being rendered
+    RenderStats lastFrame; // counters of the last complete frame
+
+    GLStateCache() { invalidate(); }
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vao);
+    // target is GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+    void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+    // capability is GL_DEPTH_TEST, GL_BLEND or GL_CULL_FACE
+    void setEnabled(GLenum capability, bool enabled);
+    void depthFunc(GLenum func);
+    void depthMask(bool write);
+    void blendFunc(GLenum sfactor, GLenum dfactor);
+
+    void drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+    void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint baseVertex);
+    void drawArrays(GLenum mode, GLint first, GLsizei count);
+    // needs glExtensions.multiDrawIndirect; counts as one draw call
+    void multiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount);
+
+    // Move this frame's counters to lastFrame and start counting again
+    void endFrame();
+
+    // Forget every cached value so the next request of each kind reaches GL
+    void invalidate();
+
+private:
+    static const unsigned int UNKNOWN = ~0u;
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    unsigned int program = UNKNOWN;
+    unsigned int vao = UNKNOWN;
+    unsigned int activeUnit = UNKNOWN;
+    unsigned int textures2D[MAX_TEXTURE_UNITS];
+    unsigned int texturesCube[MAX_TEXTURE_UNITS];
+    int capabilities[3] = {-1, -1, -1}; // depth test, blend, cull face: -1 unknown, 0 off, 1 on
+    GLenum depth = 0;
+    int depthWrite = -1; // -1 unknown, 0 off, 1 on
+    GLenum blendSrc = 0, blendDst = 0;
+
+    bool changed(unsigned int &cached, unsigned int value);
+};
+
+extern GLStateCache glState;
+
+#endif // GL_STATE_H
@@ -0,0 +1,84 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "RenderStats.h"
+
+struct GLFWwindow;
+
+// Minimal PNG writer: stored (uncompressed) deflate blocks, so it needs no zlib.
+// 'pixels' is RGB, bottom row first (as returned by glReadPixels).
+bool writePNG(const std::string &path, int width, int height, const std::vector<unsigned char> &pixels);
+
+// Scripted input for headless sessions: skip the start screen, sweep the
+// fighter left and right and fire at a steady rate
+bool scriptedKeyPressed(int key, unsigned int frame);
+
+// Renders into an offscreen framebuffer with no visible window, for CI machines
+// without a GPU (Mesa llvmpipe). On Linux the context comes from EGL with no
+// surface at all; elsewhere an invisible GLFW window provides it.
+class HeadlessSession
+{
+public:
+    unsigned int frameCount;   // frames to run before quitting
+    std::string captureDir;    // directory for PNG captures (empty = no captures)
+    unsigned int captureEvery; // capture every Nth frame
+    std::string frameLogPath;  // CSV of per-frame times (empty = no log)
+
+    unsigned int frame = 0;           // index of the frame being rendered
+    std::vector<double> frameTimesMs; // wall-clock time of each frame
+    std::vector<RenderStats> frameStats; // render counters of each frame
+
+    HeadlessSession(unsigned int frames, const std::string &captureDir, unsigned int captureEvery, const std::string &frameLogPath)
+        : frameCount(frames), captureDir(captureDir), captureEvery(captureEvery > 0 ? captureEvery : 1), frameLogPath(frameLogPath) {}
+
+    // Create the GL context, load GL with glad and bind a width x height framebuffer
+    bool init(int width, int height);
+
+    // Scripted replacement for glfwGetKey
+    bool keyPressed(int key) const
+    {
+        return scriptedKeyPressed(key, frame);
+    }
+
+    // Simulation clock: advances a fixed 1/60 s per frame so runs are reproducible
+    double time() const
+    {
+        return frame / 60.0;
+    }
+
+    bool finished() const
+    {
+        return frame >= frameCount;
+    }
+
+    // Replacement for glfwSwapBuffers: wait for the GPU, record the frame time
+    // and counters and capture the framebuffer if requested
+    void endFrame(const RenderStats &stats);
+
+    // Write the frame log and print a summary
+    void finish();
+
+    void destroy();
+
+private:
+    int width = 0, height = 0;
+    unsigned int FBO = 0, colorRBO = 0, depthRBO = 0;
+    std::chrono::steady_clock::time_point lastFrameEnd;
+
+#ifdef __linux__
+    // EGLDisplay / EGLContext (both pointer typedefs), kept opaque so EGL stays in src/Headless.cpp
+    void *display = nullptr;
+    void *context = nullptr;
+#else
+    GLFWwindow *window = nullptr;
+#endif
+
+    bool createContext();
+    void capture();
+};
+
+#endif // HEADLESS_H
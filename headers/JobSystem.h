@@ -0,0 +1,107 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of unfinished jobs in a group; JobSystem::wait() returns once it is zero
+class JobCounter
+{
+public:
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<unsigned int> pending{0};
+};
+
+// Worker threads running small jobs. Each worker has its own queue: it takes
+// its newest job first (still warm in its cache) and, when it runs dry, steals
+// the oldest job of another queue. Threads outside the system (the main thread)
+// share one more queue, and help run jobs while they wait for a counter, so the
+// system also works with no workers at all. A waiting thread only helps with
+// the jobs of the counter it waits for, so waiting on a short batch never
+// picks up an unrelated long job (such as a frame's simulation ticks).
+class JobSystem
+{
+public:
+    JobSystem() { queues.emplace_back(new Queue()); }
+    ~JobSystem() { stop(); }
+
+    // Start the workers; 0 starts one per core besides the calling thread (at least one)
+    void start(unsigned int workers = 0);
+
+    // Finish every queued job and join the workers
+    void stop();
+
+    unsigned int workerCount() const { return static_cast<unsigned int>(threads.size()); }
+
+    // Queue a job; counter counts it until it has run
+    void run(JobCounter &counter, std::function<void()> job);
+
+    // Run counter's queued jobs on this thread until it reaches zero
+    void wait(JobCounter &counter);
+
+    // body(begin, end) over [0, count) in chunks of at most grain items,
+    // spread over the workers and this thread; returns when all have run
+    template <typename Body>
+    void parallelFor(size_t count, size_t grain, const Body &body)
+    {
+        // the jobs capture two words, which std::function stores without allocating
+        struct Range
+        {
+            const Body &body;
+            size_t count, grain;
+        } range{body, count, std::max<size_t>(grain, 1)};
+        JobCounter counter;
+        for (size_t begin = 0; begin < count; begin += range.grain)
+        {
+            run(counter, [&range, begin]()
+                { range.body(begin, std::min(range.count, begin + range.grain)); });
+        }
+        wait(counter);
+    }
+
+private:
+    struct Job
+    {
+        std::function<void()> function;
+        JobCounter *counter;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] for threads outside the system, then one per worker
+    std::vector<std::thread> threads;
+
+    std::atomic<unsigned int> queued{0};   // jobs in the queues, not yet taken
+    std::atomic<unsigned int> sleeping{0}; // workers waiting on wake
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // queue of the calling thread
+    unsigned int queueIndex() const;
+
+    // Take one job (own queue newest first, else steal another's oldest) and run it;
+    // with only set, just a job of that counter
+    bool runOne(unsigned int self, const JobCounter *only = nullptr);
+
+    void workerLoop(unsigned int index);
+};
+
+// Shared by the game and the benchmark (started by them; until then jobs run in wait())
+extern JobSystem jobSystem;
+
+#endif // JOB_SYSTEM_H
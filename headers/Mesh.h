@@ -1,5 +1,9 @@
 #pragma once
 #include "header.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "MeshArena.h"
+#include "Bounds.h"
 
 struct Vertex
 {
@@ -15,6 +19,25 @@ struct Texture
     string path;
 };
 
+// Box around the vertex positions (min/max four lanes at a time with SSE where available)
+BoundingBox computeBoundingBox(const vector<Vertex> &vertices);
+
+// Sphere centred on box, just large enough to hold all the vertices
+BoundingSphere computeBoundingSphere(const vector<Vertex> &vertices, const BoundingBox &box);
+
+// Set the material.texture_diffuseN / texture_specularN samplers and bind the textures to units 0..N-1
+void bindMaterialTextures(Shader &shader, const vector<Texture> &textures, GLStateCache &state);
+
+// Store mesh vertices quantized (VertexPacking.h) when that keeps them accurate; false with --float-vertices
+extern bool packMeshVertices;
+
+// One level of detail: an index range over the mesh's vertices
+struct MeshLod
+{
+    MeshRange range;
+    float error = 0.0f; // largest deviation from the full mesh, in model units
+};
+
 class Mesh
 {
 public:
@@ -23,69 +46,36 @@ public:
     vector<unsigned int> indices;
     vector<Texture> textures;
 
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
-    {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
-
-        setupMesh();
-    }
-
-    void Draw(Shader &shader)
-    {
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        for (unsigned int i = 0; i < textures.size(); i++)
-        {
-            glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
-            string number;
-            string name = textures[i].type;
-            if (name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if (name == "texture_specular")
-                number = std::to_string(specularNr++);
-
-            shader.setInt(("material." + name + number).c_str(), i);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-        }
-        glActiveTexture(GL_TEXTURE0);
-
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-    }
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures);
+
+    // Draw with the model matrix already set on the shader (for packed vertices it must include dequantize)
+    void Draw(Shader &shader);
+
+    // Queue the mesh for sorted drawing with the given model matrix, at a level of detail
+    // (clamped to the coarsest one the mesh has)
+    void Submit(RenderQueue &queue, Shader &shader, const glm::mat4 &model, size_t lod = 0) const;
+
+    // Queue count instances as one instance run, instance k at positions[indices[k]] (positions[k]
+    // when indices is null) with the matrix translate(position) * orientation, built at flush time
+    // straight into the instance buffer. The arrays must live until the queue is flushed.
+    void SubmitInstances(RenderQueue &queue, Shader &shader, const glm::vec3 *positions, const uint32_t *indices, size_t count,
+                         const glm::mat4 &orientation, size_t lod = 0) const;
+
+    // where the mesh lives: in packedMeshArena when packed, otherwise in meshArena
+    MeshRange range;
+    bool packed = false;
+    glm::mat4 dequantize = glm::mat4(1.0f); // unorm positions -> model space (identity when not packed)
+
+    // lods[0] is the full mesh, then simplified versions with about half the triangles each
+    vector<MeshLod> lods;
+
+    // in model space, computed once at load time
+    BoundingBox box;
+    BoundingSphere bounds;
 
 private:
-    //  render data
-    unsigned int VAO, VBO, EBO;
-
-    void setupMesh()
-    {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-        // vertex positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-        // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
-
-        glBindVertexArray(0);
-    }
-};
\ No newline at end of file
+    MeshArena &arena() const { return packed ? packedMeshArena : meshArena; }
+
+    void setupMesh();
+    void buildLods();
+};
@@ -0,0 +1,75 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include "header.h"
+
+#include <cstdint>
+
+struct Vertex;
+struct PackedVertex;
+
+// Layout of the vertices in an arena (see Mesh.h and VertexPacking.h)
+enum class VertexFormat
+{
+    Float,  // Vertex, 32 bytes
+    Packed, // PackedVertex, 16 bytes
+};
+
+// Where a mesh lives inside the arena buffers
+struct MeshRange
+{
+    unsigned int firstIndex = 0; // offset into the index buffer, in indices of indexType
+    unsigned int indexCount = 0;
+    int baseVertex = 0;                      // added to every index of the mesh
+    unsigned int indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT for meshes under 65536 vertices
+
+    size_t indexSize() const { return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+    // byte offset of the first index, as glDrawElements* takes it
+    const void *indexOffset() const { return (const void *)(firstIndex * indexSize()); }
+};
+
+// Shared vertex and index buffers for every static mesh of one vertex format.
+// Meshes are sub-allocated by appending and are never freed; a single VAO
+// describes the whole arena, so switching meshes only changes draw offsets.
+// Indices are stored 16-bit for meshes with fewer than 65536 vertices and
+// 32-bit otherwise, side by side in the same element buffer.
+class MeshArena
+{
+public:
+    unsigned int VAO = 0;
+    const VertexFormat format;
+
+    explicit MeshArena(VertexFormat format) : format(format) {}
+
+    // Upload a mesh at the end of the arena, growing the buffers if needed
+    // (the vertex type must match the arena's format)
+    MeshRange add(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+    MeshRange add(const std::vector<PackedVertex> &vertices, const std::vector<unsigned int> &indices);
+
+    // Upload another index list for the vertices of base (e.g. a level of detail),
+    // with the same index type
+    MeshRange addIndices(const MeshRange &base, const std::vector<unsigned int> &indices);
+
+    size_t vertexCount() const { return verticesUsed; }
+    size_t indexBytes() const { return indexBytesUsed; }
+
+    void destroy();
+
+private:
+    unsigned int VBO = 0, EBO = 0;
+    size_t vertexCapacity = 0, indexCapacity = 0; // in vertices and bytes
+    size_t verticesUsed = 0, indexBytesUsed = 0;
+
+    MeshRange addVertexData(const void *vertices, size_t vertexCount, const std::vector<unsigned int> &indices);
+    MeshRange addIndexData(const std::vector<unsigned int> &indices, unsigned int indexType, int baseVertex);
+    size_t vertexSize() const;
+
+    void create();
+    void grow(unsigned int &buffer, size_t &capacity, size_t used, size_t elementSize, size_t required);
+    void setupAttributes();
+};
+
+extern MeshArena meshArena;       // float vertices (VertexFormat::Float)
+extern MeshArena packedMeshArena; // quantized vertices (VertexFormat::Packed)
+
+#endif // MESH_ARENA_H
@@ -0,0 +1,34 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include "header.h"
+#include "Mesh.h"
+
+// Post-transform cache statistics of an index buffer, simulated with a
+// FIFO cache of cacheSize vertices (16 is typical of current GPUs)
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // average cache miss ratio: vertex shader runs per triangle (0.5 is ideal)
+    float atvr = 0.0f; // average transformed vertex ratio: shader runs per referenced vertex (1.0 is ideal)
+};
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+// Reorder triangles so vertices are reused while still in the post-transform
+// cache (Forsyth's linear-speed algorithm). Vertex order is unchanged.
+void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount);
+
+// Reorder the clusters of an already cache-optimized index buffer so outward-facing
+// ones come first, which cuts overdraw from most view directions. The result is
+// kept only if its ACMR is within threshold times the input's.
+void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, float threshold = 1.05f);
+
+// Reorder vertices by first use in the index buffer (and remap the indices) so
+// vertex fetches walk memory forward. Unreferenced vertices are dropped.
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+// The whole pass as done at import: cache, then overdraw, then fetch order.
+// Returns the cache statistics before and after.
+std::pair<VertexCacheStats, VertexCacheStats> optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices);
+
+#endif // MESH_OPTIMIZE_H
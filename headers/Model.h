@@ -4,11 +4,27 @@
 #include "header.h"
 #include "Mesh.h"
 
+struct aiNode;
+struct aiMesh;
+struct aiScene;
+
 class Model
 {
 public:
     vector<Texture> textures_loaded;
-    tuple<float, float, float> position;
+
+    // around all meshes, in model space
+    BoundingBox box;
+    BoundingSphere bounds;
+
+    // largest error of any mesh at each level of detail, in model units
+    vector<float> lodErrors;
+
+    // Fixed rotation/scale drawn with the model, and the bounds after it
+    // (relative to where a copy is drawn, so collision and culling only add its position)
+    glm::mat4 orientation = glm::mat4(1.0f);
+    BoundingBox orientedBox;
+    BoundingSphere orientedBounds;
 
     Model(char *path)
     {
@@ -20,203 +36,49 @@ public:
             meshes[i].Draw(shader);
     }
 
-    float lerp(float a, float b, float f)
+    void Submit(RenderQueue &queue, Shader &shader, const glm::mat4 &model, size_t lod = 0) const
     {
-        return a * (1.0 - f) + (b * f);
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].Submit(queue, shader, model, lod);
     }
 
-    void modelMove(tuple<float, float, float> finalPos)
+    // Queue many copies drawn with the orientation, one instance run per mesh (see Mesh::SubmitInstances)
+    void SubmitInstances(RenderQueue &queue, Shader &shader, const glm::vec3 *positions, const uint32_t *indices, size_t count, size_t lod = 0) const
     {
-        float speed = 0.005f;
-
-        position = make_tuple(lerp(get<0>(position), get<0>(finalPos), speed), lerp(get<1>(position), get<1>(finalPos), speed), lerp(get<2>(position), get<2>(finalPos), speed));
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].SubmitInstances(queue, shader, positions, indices, count, orientation, lod);
     }
 
-    bool hasReachedTarget(tuple<float, float, float> finalPos)
-    {
-         return (get<0>(position) == get<0>(finalPos) &&
-            get<1>(position) == get<1>(finalPos) &&
-            get<2>(position) == get<2>(finalPos));
-    }
+    // Coarsest level of detail whose error stays within maxPixelError on screen, given how many
+    // pixels one world unit covers at the model's distance (the orientation scale is applied here)
+    size_t selectLod(float pixelsPerUnit, float maxPixelError) const;
 
-private:
-    // model data
-    vector<Mesh> meshes;
-    string directory;
+    // Squared distances from which each level of detail is selected (the first is 0), for a view
+    // covering pixelsAtUnitDistance pixels per world unit one unit away: the same choice as selectLod
+    // at every distance, for many copies of the model without a division each
+    void lodDistancesSquared(float pixelsAtUnitDistance, float maxPixelError, vector<float> &distances) const;
 
-    void loadModel(string path)
+    void setOrientation(const glm::mat4 &m)
     {
-        Assimp::Importer import;
-        const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
-
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-        {
-            cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
-            return;
-        }
-        directory = path.substr(0, path.find_last_of('/'));
-
-        processNode(scene->mRootNode, scene);
+        orientation = m;
+        orientedBox = transformBox(box, m);
+        orientedBounds = transformSphere(bounds, m);
     }
 
-    void processNode(aiNode *node, const aiScene *scene)
-    {
-        // process all the node's meshes (if any)
-        for (unsigned int i = 0; i < node->mNumMeshes; i++)
-        {
-            aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
-        }
-        // then do the same for each of its children
-        for (unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
-        }
-    }
+    const vector<Mesh> &getMeshes() const { return meshes; }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
-    {
-        // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
-
-        // walk through each of the mesh's vertices
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {
-            Vertex vertex;
-            glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
-            // positions
-            vector.x = mesh->mVertices[i].x;
-            vector.y = mesh->mVertices[i].y;
-            vector.z = mesh->mVertices[i].z;
-            vertex.Position = vector;
-            // normals
-            if (mesh->HasNormals())
-            {
-                vector.x = mesh->mNormals[i].x;
-                vector.y = mesh->mNormals[i].y;
-                vector.z = mesh->mNormals[i].z;
-                vertex.Normal = vector;
-            }
-            // texture coordinates
-            if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
-            {
-                glm::vec2 vec;
-                // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't
-                // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-                vec.x = mesh->mTextureCoords[0][i].x;
-                vec.y = mesh->mTextureCoords[0][i].y;
-                vertex.TexCoords = vec;
-            }
-            else
-                vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-            vertices.push_back(vertex);
-        }
-        // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-        {
-            aiFace face = mesh->mFaces[i];
-            // retrieve all indices of the face and store them in the indices vector
-            for (unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
-        }
-        // process materials
-        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-        // we assume a convention for sampler names in the shaders. Each diffuse texture should be named
-        // as 'texture_diffuseN' where N is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER.
-        // Same applies to other texture as the following list summarizes:
-        // diffuse: texture_diffuseN
-        // specular: texture_specularN
-        // normal: texture_normalN
-
-        // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-        // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
-    }
+    // Forget the imported models so the next construction imports again
+    // (their arena space and textures are not reclaimed)
+    static void clearCache();
 
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
-    {
-        vector<Texture> textures;
-        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
-        {
-            aiString str;
-            mat->GetTexture(type, i, &str);
-            bool skip = false;
-            for (unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true;
-                    break;
-                }
-            }
-            if (!skip)
-            { // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);
-            }
-        }
-        return textures;
-    }
+private:
+    // model data
+    vector<Mesh> meshes;
+    string directory;
 
-    unsigned int TextureFromFile(const char *path, const string &directory)
-    {
-        string filename = string(path);
-        filename = directory + '/' + filename;
-
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-
-        int width, height, nrComponents;
-        unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-        if (data)
-        {
-            GLenum format;
-            if (nrComponents == 1)
-                format = GL_RED;
-            else if (nrComponents == 3)
-                format = GL_RGB;
-            else if (nrComponents == 4)
-                format = GL_RGBA;
-
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Texture failed to load at path: " << path << std::endl;
-            stbi_image_free(data);
-        }
-
-        return textureID;
-    }
+    void loadModel(string path);
+    void processNode(aiNode *node, const aiScene *scene);
+    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
 };
 
 #endif // MODEL_H
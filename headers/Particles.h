@@ -0,0 +1,115 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "header.h"
+#include "GLState.h"
+#include "Random.h"
+
+#include <cstdint>
+
+// One particle as stored in the GPU buffers (interleaved, 40 bytes)
+struct Particle
+{
+    glm::vec3 position;
+    float age; // seconds since emission; dead once age >= lifetime
+    glm::vec3 velocity;
+    float lifetime;
+    uint32_t color; // RGBA8 (red in the low byte); alpha fades out over the lifetime
+    float size;     // world-space diameter of the sprite
+};
+
+static_assert(sizeof(Particle) == 40, "Particle must match the vertex layout in Particles.cpp");
+
+// CPU simulation of the particle ring, kept as structure of arrays so SSE
+// advances four particles per instruction. No GL: the fallback path uploads
+// what update() writes, and the benchmark runs it on its own.
+class ParticleSimulator
+{
+public:
+    explicit ParticleSimulator(size_t capacity = 0) { resize(capacity); }
+
+    void resize(size_t capacity);
+    void set(size_t slot, const Particle &particle);
+
+    // Advance slots [0, count) by deltaTime, multiplying velocities by damping;
+    // if out is not null, also write them there as interleaved Particles
+    void update(float deltaTime, float damping, size_t count, Particle *out);
+
+private:
+    std::vector<float> px, py, pz, vx, vy, vz, age, lifetime, size;
+    std::vector<uint32_t> color;
+};
+
+// Fixed ring of particles for explosions and engine trails.
+//
+// New particles overwrite the oldest slots. Every frame update() advances the
+// slots in use with one transform feedback pass (ping-ponging between two
+// buffers), or on the CPU with ParticleSimulator when the backend is Cpu, and
+// draw() renders them all as point sprites in one call. Emitting only costs
+// the CPU the new particles themselves.
+class ParticleSystem
+{
+public:
+    enum class Backend
+    {
+        TransformFeedback,
+        Cpu,
+    };
+
+    static const size_t DEFAULT_CAPACITY = 100000;
+
+    Random random; // for the emitters (main seeds it from the config)
+
+    // Create the buffers and the update program (shaders/particle_update.vs)
+    void init(size_t capacity, Backend backend);
+    void destroy();
+
+    // Queue a particle; it enters the ring at the next update()
+    void emit(const Particle &particle);
+
+    // count particles flying out of center in random directions
+    void emitBurst(const glm::vec3 &center, size_t count, float minSpeed, float maxSpeed, float minLifetime, float maxLifetime,
+                   const glm::vec3 &innerColor, const glm::vec3 &outerColor, float size);
+
+    // Continuous emission along velocity at rate particles per second; carry holds the
+    // fraction of a particle owed to the next frame (one per trail, starting at 0)
+    void emitTrail(const glm::vec3 &position, const glm::vec3 &velocity, float rate, float deltaTime, float &carry,
+                   float lifetime, const glm::vec3 &color, float size);
+
+    // Write the queued particles into the ring and advance every slot in use
+    void update(GLStateCache &state, float deltaTime);
+
+    // Additive point sprites, depth tested against the scene but not writing depth.
+    // shader is shaders/particle.vs/.fs.
+    void draw(GLStateCache &state, Shader &shader, const glm::mat4 &view, const glm::mat4 &projection, float viewportHeight);
+
+    // Slots simulated and drawn each frame: 0 once every particle has died
+    size_t activeCount() const { return active; }
+
+    // Drop every particle
+    void clear();
+
+private:
+    Backend backend = Backend::TransformFeedback;
+    size_t capacity = 0;
+    size_t head = 0;         // next slot to overwrite
+    size_t active = 0;       // slots [0, active) hold particles emitted since the ring was last empty
+    float time = 0.0f;       // seconds since init
+    float aliveUntil = 0.0f; // time at which the last emitted particle dies
+    std::vector<Particle> pending;
+
+    unsigned int buffers[2] = {0, 0}; // ping-pong pair (the Cpu backend only uses the first)
+    unsigned int VAOs[2] = {0, 0};
+    unsigned int current = 0; // buffer holding the latest state
+    unsigned int updateProgram = 0;
+    int deltaTimeLocation = -1, dampingLocation = -1;
+    ParticleSimulator simulator;
+
+    void writePending();
+    void upload(size_t slot, const Particle *particles, size_t count);
+};
+
+// Seconds for a particle's velocity to fall to 1/e (the same on both backends)
+const float PARTICLE_DRAG_TIME = 0.6f;
+
+#endif // PARTICLES_H
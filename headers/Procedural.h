@@ -0,0 +1,207 @@
+#ifndef PROCEDURAL_H
+#define PROCEDURAL_H
+
+#include "header.h"
+#include "Mesh.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// Procedural shapes, centred on the origin with Y up and counter-clockwise
+// outward-facing triangles.
+//
+// Every shape has a constexpr size function giving its exact vertex and index
+// counts, so callers can allocate once (or at compile time, see FixedGeometry).
+// The pointer generators write exactly that many vertices and indices, with
+// baseVertex added to every index; the vector overloads append to the vectors.
+// Indices may be 16- or 32-bit.
+//
+// With texCoords false, round shapes close their rings without the extra seam
+// column that wrapping U needs, and every vertex gets UV (0, 0). Caps and
+// faces always have their own vertices, so their normals stay flat.
+
+struct GeometrySize
+{
+    size_t vertexCount;
+    size_t indexCount;
+};
+
+constexpr size_t ringColumns(int segments, bool texCoords)
+{
+    return static_cast<size_t>(segments) + (texCoords ? 1 : 0);
+}
+
+// side: two rings; caps: a centre and a ring each
+constexpr GeometrySize cylinderSize(int segments, bool texCoords = false)
+{
+    return {2 * ringColumns(segments, texCoords) + 2 * (static_cast<size_t>(segments) + 1), 12 * static_cast<size_t>(segments)};
+}
+
+// side: an apex per segment (for its normal) and the base ring; base: a centre and a ring
+constexpr GeometrySize coneSize(int segments, bool texCoords = false)
+{
+    return {2 * static_cast<size_t>(segments) + ringColumns(segments, texCoords) + 1, 6 * static_cast<size_t>(segments)};
+}
+
+// stacks - 1 rings between two poles (one pole vertex per slice when textured)
+constexpr GeometrySize sphereSize(int slices, int stacks, bool texCoords = false)
+{
+    return {2 * (texCoords ? static_cast<size_t>(slices) : 1) + (static_cast<size_t>(stacks) - 1) * ringColumns(slices, texCoords),
+            6 * static_cast<size_t>(slices) * (static_cast<size_t>(stacks) - 1)};
+}
+
+// a sphere split at the equator: hemisphereStacks rings per half
+constexpr GeometrySize capsuleSize(int slices, int hemisphereStacks, bool texCoords = false)
+{
+    return sphereSize(slices, 2 * hemisphereStacks + 1, texCoords);
+}
+
+constexpr GeometrySize quadSize()
+{
+    return {4, 6};
+}
+
+constexpr GeometrySize boxSize()
+{
+    return {24, 36};
+}
+
+// Along Y, from -height/2 to height/2
+template <typename Index>
+void generateCylinder(float height, float radius, int segments, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// Base at -height/2, apex at height/2
+template <typename Index>
+void generateCone(float height, float radius, int segments, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// UV sphere with its poles on Y (stacks >= 2)
+template <typename Index>
+void generateSphere(float radius, int slices, int stacks, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// Cylinder of the given height with hemispheres of radius on its ends (total length height + 2 * radius)
+template <typename Index>
+void generateCapsule(float height, float radius, int slices, int hemisphereStacks, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// width x height in the XY plane, facing +Z
+template <typename Index>
+void generateQuad(float width, float height, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// A face of 4 vertices per side, so the edges stay sharp
+template <typename Index>
+void generateBox(const glm::vec3 &halfExtents, Vertex *vertices, Index *indices, Index baseVertex = 0);
+
+// Grow the vectors by exactly size and return where the new vertices and indices start
+template <typename Index>
+std::pair<Vertex *, Index *> appendGeometry(std::vector<Vertex> &vertices, std::vector<Index> &indices, GeometrySize size, Index &baseVertex)
+{
+    baseVertex = static_cast<Index>(vertices.size());
+    vertices.resize(vertices.size() + size.vertexCount);
+    indices.resize(indices.size() + size.indexCount);
+    return {vertices.data() + vertices.size() - size.vertexCount, indices.data() + indices.size() - size.indexCount};
+}
+
+template <typename Index>
+void generateCylinder(float height, float radius, int segments, std::vector<Vertex> &vertices, std::vector<Index> &indices, bool texCoords = false)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, cylinderSize(segments, texCoords), base);
+    generateCylinder(height, radius, segments, texCoords, out.first, out.second, base);
+}
+
+template <typename Index>
+void generateCone(float height, float radius, int segments, std::vector<Vertex> &vertices, std::vector<Index> &indices, bool texCoords = false)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, coneSize(segments, texCoords), base);
+    generateCone(height, radius, segments, texCoords, out.first, out.second, base);
+}
+
+template <typename Index>
+void generateSphere(float radius, int slices, int stacks, std::vector<Vertex> &vertices, std::vector<Index> &indices, bool texCoords = false)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, sphereSize(slices, stacks, texCoords), base);
+    generateSphere(radius, slices, stacks, texCoords, out.first, out.second, base);
+}
+
+template <typename Index>
+void generateCapsule(float height, float radius, int slices, int hemisphereStacks, std::vector<Vertex> &vertices, std::vector<Index> &indices, bool texCoords = false)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, capsuleSize(slices, hemisphereStacks, texCoords), base);
+    generateCapsule(height, radius, slices, hemisphereStacks, texCoords, out.first, out.second, base);
+}
+
+template <typename Index>
+void generateQuad(float width, float height, std::vector<Vertex> &vertices, std::vector<Index> &indices)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, quadSize(), base);
+    generateQuad(width, height, out.first, out.second, base);
+}
+
+template <typename Index>
+void generateBox(const glm::vec3 &halfExtents, std::vector<Vertex> &vertices, std::vector<Index> &indices)
+{
+    Index base;
+    auto out = appendGeometry(vertices, indices, boxSize(), base);
+    generateBox(halfExtents, out.first, out.second, base);
+}
+
+// Geometry sized at compile time, for shapes whose segment counts are constants
+// (no heap allocation; 16-bit indices unless the shape needs more)
+template <size_t VertexCount, size_t IndexCount, typename Index = uint16_t>
+struct FixedGeometry
+{
+    static_assert(VertexCount - 1 <= std::numeric_limits<Index>::max(), "too many vertices for the index type");
+
+    std::array<Vertex, VertexCount> vertices;
+    std::array<Index, IndexCount> indices;
+};
+
+template <int Segments, typename Index = uint16_t>
+using CylinderGeometry = FixedGeometry<cylinderSize(Segments).vertexCount, cylinderSize(Segments).indexCount, Index>;
+
+template <int Segments, typename Index = uint16_t>
+using ConeGeometry = FixedGeometry<coneSize(Segments).vertexCount, coneSize(Segments).indexCount, Index>;
+
+template <int Slices, int Stacks, typename Index = uint16_t>
+using SphereGeometry = FixedGeometry<sphereSize(Slices, Stacks).vertexCount, sphereSize(Slices, Stacks).indexCount, Index>;
+
+template <int Slices, int HemisphereStacks, typename Index = uint16_t>
+using CapsuleGeometry = FixedGeometry<capsuleSize(Slices, HemisphereStacks).vertexCount, capsuleSize(Slices, HemisphereStacks).indexCount, Index>;
+
+template <int Segments, typename Index = uint16_t>
+CylinderGeometry<Segments, Index> makeCylinder(float height, float radius)
+{
+    CylinderGeometry<Segments, Index> geometry;
+    generateCylinder<Index>(height, radius, Segments, false, geometry.vertices.data(), geometry.indices.data());
+    return geometry;
+}
+
+template <int Segments, typename Index = uint16_t>
+ConeGeometry<Segments, Index> makeCone(float height, float radius)
+{
+    ConeGeometry<Segments, Index> geometry;
+    generateCone<Index>(height, radius, Segments, false, geometry.vertices.data(), geometry.indices.data());
+    return geometry;
+}
+
+template <int Slices, int Stacks, typename Index = uint16_t>
+SphereGeometry<Slices, Stacks, Index> makeSphere(float radius)
+{
+    SphereGeometry<Slices, Stacks, Index> geometry;
+    generateSphere<Index>(radius, Slices, Stacks, false, geometry.vertices.data(), geometry.indices.data());
+    return geometry;
+}
+
+template <int Slices, int HemisphereStacks, typename Index = uint16_t>
+CapsuleGeometry<Slices, HemisphereStacks, Index> makeCapsule(float height, float radius)
+{
+    CapsuleGeometry<Slices, HemisphereStacks, Index> geometry;
+    generateCapsule<Index>(height, radius, Slices, HemisphereStacks, false, geometry.vertices.data(), geometry.indices.data());
+    return geometry;
+}
+
+#endif // PROCEDURAL_H
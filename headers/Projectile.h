@@ -3,116 +3,92 @@
 #define PROJECTILE_H
 
 #include "header.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "MeshArena.h"
+#include "Mesh.h"
 
-#include <glm/glm.hpp>
-#include "Cylinder.h"
+#include <cstdint>
 
+// What every projectile shares: the cylinder mesh, its bounds and the limits
+// past which a projectile is dropped. The projectiles themselves live in a
+// ProjectileList.
 class Projectile
 {
 public:
-    glm::vec3 position;
-    glm::vec3 velocity;
-    bool active;
+    // Cylinder geometry shared by all projectiles (in meshArena)
+    static MeshRange geometry;
 
-    // Static members for cylinder geometry
-    static unsigned int VAO;
-    static unsigned int VBO, EBO;
-    static unsigned int indexCount;
+    // of the cylinder, in model space (known before any GL upload)
+    static BoundingBox box;
+    static BoundingSphere bounds;
 
-    Projectile(glm::vec3 startPos, glm::vec3 vel)
-        : position(startPos), velocity(vel), active(true), lifetime(0.0f) {}
+    static constexpr float maxDistance = 100.0f; // from the origin
+    static constexpr float maxLifetime = 5.0f;   // seconds
 
     // Initialize the cylinder geometry (call once)
-    static void initializeCylinder()
-    {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        generateCylinder(1.0f, 0.1f, 36, vertices, indices);
-        indexCount = indices.size();
-
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
+    static void initializeCylinder();
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    // Rotation that aligns the cylinder with velocity
+    static glm::mat4 getOrientation(const glm::vec3 &velocity);
+};
 
-        // Vertex Positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+// Advance count projectiles stored as structure of arrays by deltaTime, and set
+// expired[i] to 1 (else 0) for those now further than maxDistance from the
+// origin or older than maxLifetime. Runs 8 (AVX) or 4 (SSE) projectiles per
+// step where available; returns the number expired.
+size_t integrateProjectiles(float *x, float *y, float *z, const float *vx, const float *vy, const float *vz, float *lifetime,
+                            size_t count, float deltaTime, float maxDistance, float maxLifetime, uint8_t *expired);
+
+// The live projectiles of one side, in the order they were fired. Positions,
+// velocities and lifetimes are kept as structure of arrays for update(), along
+// with each position before the last update() for drawing between ticks.
+class ProjectileList
+{
+public:
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
 
-        // Vertex Normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+    void clear();
+    void add(const glm::vec3 &position, const glm::vec3 &velocity);
+    void remove(size_t index);
 
-        glBindVertexArray(0);
-    }
+    // Move every projectile and drop the ones out of bounds or past their lifetime
+    void update(float deltaTime);
 
-    // Update projectile position
-    void update(float deltaTime)
+    glm::vec3 getPosition(size_t index) const { return glm::vec3(x[index], y[index], z[index]); }
+    // alpha of the way from the position before the last update() to the current one
+    glm::vec3 getInterpolatedPosition(size_t index, float alpha) const
     {
-        position += velocity * deltaTime;
-        lifetime += deltaTime;
-        // Deactivate if out of bounds or exceeds lifetime
-        if (glm::length(position) > 100.0f || lifetime > maxLifetime)
-        {
-            active = false;
-        }
+        return glm::mix(glm::vec3(previousX[index], previousY[index], previousZ[index]), getPosition(index), alpha);
     }
+    glm::vec3 getVelocity(size_t index) const { return glm::vec3(vx[index], vy[index], vz[index]); }
 
-    // Render the projectile
-    void Draw(Shader &shader) const
-    {
-        shader.use();
-
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, position);
+    glm::vec3 getBoundingBoxMin(size_t index) const { return getPosition(index) + extents[index].min; }
+    glm::vec3 getBoundingBoxMax(size_t index) const { return getPosition(index) + extents[index].max; }
 
-        // Rotate to align with velocity
-        if (glm::length(velocity) > 0.0f)
-        {
-            glm::vec3 dir = glm::normalize(velocity);
-            float angle = glm::acos(glm::dot(dir, glm::vec3(0.0f, 1.0f, 0.0f)));
-            glm::vec3 axis = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), dir);
-            if (glm::length(axis) > 0.001f)
-                modelMatrix = glm::rotate(modelMatrix, angle, glm::normalize(axis));
-        }
-
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f)); // Adjust size as needed
-
-        shader.setMat4("model", modelMatrix);
-
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-    }
-
-    glm::vec3 getBoundingBoxMin() const
+    // World-space sphere for culling
+    BoundingSphere getBoundingSphere(size_t index, float alpha = 1.0f) const
     {
-        // Based on cylinder dimensions (height=1.0f, radius=0.1f)
-        return position - glm::vec3(0.1f, 0.5f, 0.1f);
+        BoundingSphere sphere = Projectile::bounds;
+        sphere.center += getInterpolatedPosition(index, alpha);
+        return sphere;
     }
 
-    glm::vec3 getBoundingBoxMax() const
-    {
-        // Based on cylinder dimensions (height=1.0f, radius=0.1f)
-        return position + glm::vec3(0.1f, 0.5f, 0.1f);
-    }
+    // Translation plus Projectile::getOrientation()
+    glm::mat4 getModelMatrix(size_t index, float alpha = 1.0f) const;
+
+    // Render one projectile
+    void Draw(size_t index, Shader &shader, float alpha = 1.0f) const;
+
+    // Queue one projectile for sorted drawing with a flat colour material
+    void Submit(size_t index, RenderQueue &queue, Shader &shader, const glm::vec3 &materialColor, const glm::vec3 &emissionColor, float alpha = 1.0f) const;
 
 private:
-    float lifetime;
-    float maxLifetime = 5.0f; // seconds
+    std::vector<float> x, y, z, vx, vy, vz, lifetime;
+    std::vector<float> previousX, previousY, previousZ;
+    std::vector<BoundingBox> extents; // box around the rotated cylinder, relative to the position
+    std::vector<uint8_t> expired;     // scratch for update()
 };
 
-// Initialize static members
-unsigned int Projectile::VAO = 0;
-unsigned int Projectile::VBO = 0;
-unsigned int Projectile::EBO = 0;
-unsigned int Projectile::indexCount = 0;
-
 #endif // PROJECTILE_H
@@ -0,0 +1,104 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small, fast PRNG (xoshiro128**) owned by a single subsystem.
+// Unlike the global rand(), each instance is independent, so subsystems can
+// run on different threads and a whole session can be replayed from its seed.
+class Random
+{
+public:
+    // Seed the generator; 'stream' lets several subsystems share one config
+    // seed while still producing unrelated sequences
+    explicit Random(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        reseed(seed, stream);
+    }
+
+    void reseed(uint64_t seed, uint64_t stream = 0)
+    {
+        // expand the seed with splitmix64 so that nearby seeds give unrelated states
+        uint64_t x = seed ^ (stream * 0x9E3779B97F4A7C15ull);
+        for (int i = 0; i < 4; i += 2)
+        {
+            uint64_t z = splitmix64(x);
+            state[i] = static_cast<uint32_t>(z);
+            state[i + 1] = static_cast<uint32_t>(z >> 32);
+        }
+        // the all-zero state is the only invalid one
+        if ((state[0] | state[1] | state[2] | state[3]) == 0)
+            state[0] = 1;
+    }
+
+    // Next raw 32-bit value
+    uint32_t next()
+    {
+        const uint32_t result = rotl(state[1] * 5, 7) * 9;
+        const uint32_t t = state[1] << 9;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+
+        return result;
+    }
+
+    // Uniform integer in [0, bound) without modulo bias (Lemire's method)
+    uint32_t below(uint32_t bound)
+    {
+        uint64_t m = static_cast<uint64_t>(next()) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound)
+        {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold)
+            {
+                m = static_cast<uint64_t>(next()) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // Uniform float in [0, 1)
+    float nextFloat()
+    {
+        return (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Uniform float in [min, max)
+    float range(float min, float max)
+    {
+        return min + (max - min) * nextFloat();
+    }
+
+private:
+    uint32_t state[4];
+
+    static uint32_t rotl(uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    static uint64_t splitmix64(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Stream ids for the subsystems that own a generator
+enum RandomStream
+{
+    RANDOM_STREAM_ENEMY_FIRE = 1,
+    RANDOM_STREAM_CAMERA_SHAKE = 2,
+    RANDOM_STREAM_PARTICLES = 3
+};
+
+#endif // RANDOM_H
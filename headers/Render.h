@@ -0,0 +1,12 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "header.h"
+
+// Load the six faces (+X, -X, +Y, -Y, +Z, -Z) of a cubemap texture
+unsigned int loadCubemap(const std::vector<std::string> &faces);
+
+// Unit cube VAO (positions only) for drawing the skybox
+unsigned int createSkyboxVAO();
+
+#endif // RENDER_H
@@ -0,0 +1,122 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "header.h"
+#include "GLState.h"
+#include "MeshArena.h"
+
+#include <cstdint>
+#include <functional>
+
+struct Texture;
+
+// DrawItem::run of a single draw
+const size_t NO_INSTANCE_RUN = SIZE_MAX;
+
+// One opaque indexed draw: geometry, material and transform (or a run of instances)
+struct DrawItem
+{
+    Shader *shader;
+    unsigned int VAO;
+    MeshRange range;
+    const std::vector<Texture> *textures; // textured material (null for flat colours)
+    glm::vec3 materialColor;              // flat material, used when textures is null
+    glm::vec3 emissionColor;
+    glm::mat4 model;
+    uint64_t sortKey;
+    size_t run; // the queue's instance run drawn, or NO_INSTANCE_RUN
+};
+
+// Per-instance vertex data for indirect submission (attribute locations 3-8)
+struct InstanceData
+{
+    glm::mat4 model;         // locations 3-6
+    glm::vec3 materialColor; // location 7
+    glm::vec3 emissionColor; // location 8
+};
+
+// Writes the InstanceData of instances [begin, end) of a run to out[begin, end)
+typedef std::function<void(InstanceData *out, size_t begin, size_t end)> InstanceFill;
+
+// Layout fixed by GL for glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Collects the opaque draws of a frame and submits them sorted by
+// shader, then material, then VAO (then index type and mesh), so each state change happens once per run.
+//
+// With indirect set, each run of draws sharing a shader, material, arena and index type becomes
+// one glMultiDrawElementsIndirect call: draws of the same mesh are merged into
+// one instanced command and transforms/colours come from an instance buffer,
+// which is mapped and filled in parallel batches on the job system.
+// The shaders select that path with their 'instanced' uniform.
+//
+// Many instances of one mesh can be submitted as a single run whose instance
+// data the caller writes itself, at flush time, straight into the mapped buffer.
+class RenderQueue
+{
+public:
+    bool indirect = false; // requires glExtensions.multiDrawIndirect and geometry in the mesh arenas
+
+    void submit(Shader &shader, unsigned int VAO, const MeshRange &range, const std::vector<Texture> &textures, const glm::mat4 &model);
+    void submit(Shader &shader, unsigned int VAO, const MeshRange &range, const glm::vec3 &materialColor, const glm::vec3 &emissionColor, const glm::mat4 &model);
+
+    // Draw count instances of a textured mesh as one run. Their InstanceData is written by fill
+    // during flush(), into the mapped instance buffer in parallel batches, so fill must be safe
+    // to run on worker threads and what it reads must live until the flush. The per-draw path
+    // stages the run and draws the instances one by one.
+    void submitInstances(Shader &shader, unsigned int VAO, const MeshRange &range, const std::vector<Texture> &textures, size_t count, InstanceFill fill);
+
+    // Sort, draw everything through the state cache and empty the queue.
+    // Per-frame uniforms (view, projection, lights) must already be set on each shader.
+    void flush(GLStateCache &state);
+
+    size_t size() const { return items.size(); }
+
+    void destroy();
+
+private:
+    std::vector<DrawItem> items;
+
+    struct InstanceRun
+    {
+        size_t count;
+        InstanceFill fill;
+        size_t first; // in the instance buffer (or the staging vector), set by the flush
+    };
+    std::vector<InstanceRun> runs;
+
+    // indirect path
+    struct Batch
+    {
+        Shader *shader;
+        const std::vector<Texture> *textures;
+        unsigned int VAO;
+        unsigned int indexType; // one per glMultiDrawElementsIndirect call
+        size_t firstCommand;
+        size_t commandCount;
+    };
+    std::vector<InstanceData> instances; // staging, for the per-draw path's runs and when the instance buffer cannot be mapped
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<Batch> batches;
+    unsigned int instanceVBO = 0, indirectBuffer = 0;
+    size_t instanceCapacity = 0, commandCapacity = 0;
+    std::vector<unsigned int> instanceVAOs; // VAOs whose attributes 3-8 point at instanceVBO
+
+    // Place the runs after first instances and total the instances
+    size_t placeRuns(size_t first);
+    // Write every run's instances into out (indexed like the instance buffer)
+    void fillRuns(InstanceData *out);
+
+    void flushDirect(GLStateCache &state);
+    void flushIndirect(GLStateCache &state);
+    void setupInstanceAttributes(GLStateCache &state, unsigned int VAO);
+};
+
+#endif // RENDER_QUEUE_H
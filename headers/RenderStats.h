@@ -0,0 +1,16 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// Per-frame render counters, filled by GLStateCache (and by the frustum culling in the main loop and the particle system)
+struct RenderStats
+{
+    unsigned int drawCalls = 0;        // glDraw* calls
+    unsigned int stateChanges = 0;     // state-setting GL calls actually issued
+    unsigned int redundantSkipped = 0; // state requests that matched the cache and were dropped
+    unsigned int triangles = 0;        // triangles submitted through the render queue
+    unsigned int objectsVisible = 0;   // objects that passed the frustum test
+    unsigned int objectsCulled = 0;    // objects outside the view frustum, not submitted
+    unsigned int particles = 0;        // particle slots simulated and drawn
+};
+
+#endif // RENDER_STATS_H
@@ -0,0 +1,19 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "header.h"
+#include "Mesh.h"
+
+// Quadric edge-collapse simplification (Garland & Heckbert).
+//
+// Vertices with the same position are treated as one, so meshes split at
+// normal or UV seams still collapse as a whole surface. Every edge collapses
+// onto one of its endpoints, so the result indexes the same vertex buffer
+// (the LODs of a mesh share its vertices in the arena). Stops at
+// targetIndexCount or when no edge can collapse without flipping a triangle.
+//
+// error receives the largest collapse error, as a distance in model units.
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                       size_t targetIndexCount, float *error = nullptr);
+
+#endif // SIMPLIFY_H
@@ -0,0 +1,116 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "header.h"
+#include "Formation.h"
+#include "Projectile.h"
+#include "Collision.h"
+#include "Random.h"
+
+// Keys that steer the fighter, read on the main thread for the ticks that run as a job
+struct FighterInput
+{
+    bool left = false, right = false, fire = false;
+    int cameraPreset = 0; // 1-3 when the camera is at that predefined position (which sets the fighter's bounds), else 0
+};
+
+// What happened during a tick, so the caller can play sounds, shake the camera and spawn effects
+struct SimulationEvents
+{
+    int shotsFired = 0; // by the fighter
+    int enemiesDestroyed = 0;
+    int playerHits = 0;
+    std::vector<glm::vec3> destroyedAt; // positions of the destroyed enemies
+
+    // Add the events of a later tick
+    void append(const SimulationEvents &later)
+    {
+        shotsFired += later.shotsFired;
+        enemiesDestroyed += later.enemiesDestroyed;
+        playerHits += later.playerHits;
+        destroyedAt.insert(destroyedAt.end(), later.destroyedAt.begin(), later.destroyedAt.end());
+    }
+};
+
+// What drawing needs from a Simulation, copied once its ticks are done so the
+// next ticks can run on a worker while the copy is drawn
+struct SimulationSnapshot
+{
+    glm::vec3 fighterPrevious, fighterPosition; // before and after the last tick
+    float fighterPreviousTilt = 0.0f, fighterTilt = 0.0f;
+    std::vector<glm::vec3> enemyPrevious, enemyPositions; // of the live enemies, before and after the last tick
+    ProjectileList projectiles;
+    ProjectileList enemyProjectiles;
+    int score = 0;
+    int playerLives = 0;
+};
+
+// Game state advanced by tick() at a fixed rate, independent of the frame rate.
+// It makes no GL or audio calls, so it can run headless and be benchmarked on its own.
+class Simulation
+{
+public:
+    // the player's fighter, moving sideways along z (and before the last tick)
+    glm::vec3 fighterStart = glm::vec3(4.5f, 0.0f, 0.0f);
+    glm::vec3 fighterPosition = fighterStart;
+    glm::vec3 fighterPrevious = fighterStart;
+    float fighterVelocity = 0.0f;
+    float fighterTilt = 0.0f; // roll in degrees while moving
+    float fighterPreviousTilt = 0.0f;
+
+    float fighterAcceleration = 10.0f;
+    float fighterMaxSpeed = 5.0f;
+    float fighterDamping = 5.0f;
+    float fighterMaxTilt = 15.0f;
+    float fighterTiltSpeed = 5.0f;
+    float fighterMinZ[3] = {-5.0f, -10.0f, -7.0f}; // bounds for camera presets 1-3
+    float fighterMaxZ[3] = {5.0f, 10.0f, 7.0f};
+
+    // fighter shooting
+    float fighterShootCooldown = 0.5f; // seconds
+    float fighterShootTimer = 0.0f;
+    bool fireHeld = false; // fire must be released between shots
+
+    Formation formation;
+    ProjectileList projectiles;
+    ProjectileList enemyProjectiles;
+
+    // enemy formation movement (sideways along z, down towards the player along -x)
+    int enemyDirection = 1;              // 1 for right, -1 for left
+    float enemyMoveSpeed = 2.5f;         // Units per second
+    float enemyMoveDownDistance = 3.0f;  // Units to move down when changing direction
+    float enemyBoundaryLeft = -17.0f;    // the wave turns when its slots would pass these z values
+    float enemyBoundaryRight = 17.0f;
+
+    // enemy shooting
+    float enemyShootCooldown = 1.0f; // Cooldown period for enemies (in seconds)
+    float enemyShootTimer = 0.0f;
+    Random enemyFireRandom;
+
+    // hitboxes relative to the fighter's and each enemy's position (main replaces them with the models' oriented boxes)
+    BoundingBox fighterBox = {glm::vec3(-2.0f), glm::vec3(2.0f)};
+    BoundingBox enemyBox = {glm::vec3(-2.5f), glm::vec3(2.5f)};
+
+    // Scoring system
+    int score = 0;
+    int playerLives = 3; // Player starts with 3 lives
+    bool gameOver = false;
+
+    // Start a new game with a live enemy in every slot and the fighter at rest at fighterStart
+    void reset(std::vector<glm::vec3> enemySlots);
+
+    // Advance the game by deltaTime seconds with the fighter steered by input. The fighter,
+    // formation and projectiles keep where they were before it, for drawing between ticks.
+    SimulationEvents tick(float deltaTime, const FighterInput &input);
+
+    // Copy the state drawing needs (reusing the snapshot's storage)
+    void takeSnapshot(SimulationSnapshot &snapshot) const;
+
+private:
+    // Fire, move and tilt the fighter for one tick
+    void updateFighter(float deltaTime, const FighterInput &input, SimulationEvents &events);
+
+    SweptBoxSet boltBoxes; // world boxes and moves of the bolts being tested, rebuilt by each collision pass
+};
+
+#endif // SIMULATION_H
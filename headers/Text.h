@@ -0,0 +1,32 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "header.h"
+
+struct Character
+{
+    unsigned int TextureID; // ID handle of the glyph texture
+    glm::ivec2 Size;        // Size of the glyph (width, height)
+    glm::ivec2 Bearing;     // Offset from baseline to left/top of the glyph
+    unsigned int Advance;   // Horizontal offset to advance to the next glyph
+};
+
+// One laid-out glyph: its texture and 2 triangles of (x, y, u, v)
+struct GlyphQuad
+{
+    unsigned int TextureID;
+    float vertices[6][4];
+};
+
+extern unsigned int textVAO, textVBO;        // VAO and VBO for text rendering
+extern std::map<char, Character> Characters; // Stores characters with their OpenGL textures
+
+// FUNÇÕES PARA TEXTO: initTextRendering e RenderText
+void initTextRendering(const std::string &fontPath);
+
+// Posiciona os glifos do texto (sem chamadas OpenGL); caracteres sem glifo são ignorados
+void layoutText(const std::string &text, float x, float y, float scale, std::vector<GlyphQuad> &quads);
+
+void RenderText(Shader &s, std::string text, float x, float y, float scale, glm::vec3 color);
+
+#endif // TEXT_H
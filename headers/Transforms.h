@@ -0,0 +1,23 @@
+#ifndef TRANSFORMS_H
+#define TRANSFORMS_H
+
+#include "header.h"
+#include "JobSystem.h"
+
+#include <cstdint>
+
+// Entities per job when building transforms in parallel (smaller counts run on the calling thread)
+const size_t TRANSFORM_BATCH = 4096;
+
+// World matrices of count entities sharing one orientation (rotation and scale,
+// combined once by the caller): matrix k = translate(positions[indices[k]]) * orientation,
+// or of positions[k] when indices is null. Matrix k is written stride bytes after
+// matrix k - 1, so it can go straight into an interleaved instance buffer
+// (sizeof(glm::mat4) for a plain array). Only the translation depends on the
+// entity, so each matrix is the orientation with its last column offset, four
+// floats per SSE instruction. Batches of TRANSFORM_BATCH run as jobs when jobs
+// is not null.
+void buildTransforms(const glm::vec3 *positions, const uint32_t *indices, size_t count, const glm::mat4 &orientation,
+                     void *matrices, size_t stride, JobSystem *jobs = &jobSystem);
+
+#endif // TRANSFORMS_H
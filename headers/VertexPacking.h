@@ -0,0 +1,34 @@
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+#include "header.h"
+#include "Mesh.h"
+
+#include <cstdint>
+
+// 16-byte vertex (half of Vertex):
+//   position   3 x 16-bit unorm inside the mesh's bounding box (+ padding)
+//   normal     GL_INT_2_10_10_10_REV snorm
+//   texCoords  2 x half float
+struct PackedVertex
+{
+    uint16_t position[4];
+    uint32_t normal;
+    uint16_t texCoords[2];
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+uint16_t floatToHalf(float value);
+uint32_t packSnorm10(const glm::vec3 &v);
+
+// Whether the packed format keeps these vertices accurate enough: texture
+// coordinates must fit half precision and the box must not be flat along an axis
+bool canPackVertices(const std::vector<Vertex> &vertices, const BoundingBox &box);
+
+// Quantize vertices against box. Returns the matrix that maps the unorm
+// positions back into model space, to be applied before the model matrix.
+// Normals are stored pre-scaled by the box size so that the usual
+// inverse-transpose of (model * dequantize) still transforms them correctly.
+glm::mat4 packVertices(const std::vector<Vertex> &vertices, const BoundingBox &box, std::vector<PackedVertex> &packed);
+
+#endif // VERTEX_PACKING_H
@@ -1,35 +1,25 @@
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
+#pragma once
+// Common includes for the game's own headers. Third-party libraries that only
+// one module needs (Assimp, FreeType, SFML, EGL, stb_image's implementation)
+// are included by that module's .cpp file instead.
 
-#define GLM_ENABLE_EXPERIMENTAL
+#include <glad/glad.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <glm/gtx/string_cast.hpp>
-
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
 
 #include <shader_m.h>
 #include <camera.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "../include/stb_image.h"
-
-
 #include <iostream>
 
+#include <cstddef>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <tuple>
 #include <vector>
-#include <random>
 #include <map>
 
-#include <SFML/Audio.hpp>
-#include <iostream>
-
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
-using namespace std;
\ No newline at end of file
+using namespace std;
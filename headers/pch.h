@@ -0,0 +1,32 @@
+#ifndef PCH_H
+#define PCH_H
+
+// Precompiled header: third-party and standard headers that rarely change.
+// The Makefile force-includes it into every C++ translation unit; each file
+// still includes what it uses, so the tree also builds without it.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <shader_m.h>
+#include <camera.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#endif // PCH_H
@@ -1,20 +1,30 @@
 #include "headers/header.h"
+#include <GLFW/glfw3.h>
+#include "stb_image.h"
+
 #include "headers/Model.h"
 #include "headers/Enemy.h"
 #include "headers/Projectile.h"
+#include "headers/Simulation.h"
+#include "headers/Text.h"
+#include "headers/Random.h"
+#include "headers/Config.h"
+#include "headers/Headless.h"
+#include "headers/Audio.h"
+#include "headers/Render.h"
+#include "headers/GLState.h"
+#include "headers/RenderQueue.h"
+#include "headers/GLExtensions.h"
+#include "headers/Frustum.h"
+#include "headers/Particles.h"
+#include "headers/FixedTimestep.h"
+#include "headers/JobSystem.h"
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
-void processInput(GLFWwindow *window, Model &fighter1);
-unsigned int loadCubemap(vector<std::string> faces);
-
-sf::Music themeMusic;
-sf::SoundBuffer shootBuffer;
-sf::Sound shootSound(shootBuffer);
-
-sf::SoundBuffer explosionBuffer;
-sf::Sound explosionSound(explosionBuffer);
+void processInput(GLFWwindow *window);
+FighterInput readFighterInput(GLFWwindow *window);
 
 // settings
 const unsigned int SCR_WIDTH = 1920;
@@ -24,8 +34,11 @@ const unsigned int SCR_HEIGHT = 1080;
 glm::vec3 lightPos(0.0f, 0.0f, 15.0f);
 
 // timing
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+float deltaTime = 0.0f; // wall-clock time of the last frame, for the camera and effects
+double lastFrame = 0.0;
+
+// the game itself advances in fixed ticks (--tick-rate) and is drawn between the last two
+FixedTimestep timestep;
 
 // pressed
 bool play1 = false, play2 = false, play3 = false, play4 = false, play5 = false, play6 = false;
@@ -37,8 +50,8 @@ float shakeDuration = 0.2f;  // Duration of the shaking effect in seconds
 float shakeTimer = 0.0f;     // Timer to track the remaining shake time
 float shakeIntensity = 0.2f; // Intensity of the shaking effect
 
-// tilt angle for fighter
-float fighterTiltAngle = 0.0f;
+// random generator for the camera shake (seeded from the config in main)
+Random shakeRandom;
 
 // predefined positions
 glm::vec3 cameraPos1 = glm::vec3(-2.47806f, 1.00429f, 0.031182f);
@@ -57,341 +70,270 @@ float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 bool cameraLocked = true;
 
-// enemy
-int enemyDirection = 1;               // 1 for right, -1 for left
-float enemyMoveSpeed = 500.0f;        // Units per second
-float enemyMoveDownDistance = 600.0f; // Units to move down when changing direction
-float enemyBoundaryLeft = -2000.0f;   // 25 units left of current start
-float enemyBoundaryRight = 2000.0f;   // 25 units right of current start
-bool shouldMoveDown = false;          // Flag to indicate if enemies should move down
-
 bool victory = false; // Flag to indicate if the player has won
 
-// projectiles
-std::vector<Projectile> projectiles;
-std::vector<Projectile> enemyProjectiles;
+// game state (fighter, enemies, projectiles, score) advanced once per tick
+Simulation simulation;
 
-struct Character
-{
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2 Size;        // Size of the glyph (width, height)
-    glm::ivec2 Bearing;     // Offset from baseline to left/top of the glyph
-    unsigned int Advance;   // Horizontal offset to advance to the next glyph
-};
-
-// Scoring system
-int score = 0;
-int playerLives = 3; // Player starts with 3 lives
-bool gameOver = false;
-
-unsigned int textVAO, textVBO;        // VAO and VBO for text rendering
-std::map<char, Character> Characters; // Stores characters with their OpenGL textures
-
-// Function to initialize audio
-// Function to initialize audio
-bool initializeAudio()
-{
-    // Load and play theme music
-    if (!themeMusic.openFromFile("resources/theme.ogg"))
-    {
-        std::cerr << "Error: Unable to load theme music.\n";
-        return false;
-    }
+// Each frame's ticks run as one job while the main thread draws the state the
+// previous frame's ticks left (copied into the snapshot), so drawing lags the
+// simulation by a frame. Sounds and effects are started once the job is done.
+JobCounter simulationJob;
+SimulationSnapshot snapshot;
+SimulationEvents simulationEvents; // of the ticks in the job
 
-    themeMusic.setVolume(50.0f);
-    themeMusic.setLooping(true);
-    themeMusic.play();
+// where the invaders are drawn this frame, the visible ones by level of detail (drawn as one
+// instance run per level) and the squared camera distances at which the levels start
+std::vector<glm::vec3> enemyDrawPositions;
+std::vector<std::vector<uint32_t>> enemiesByLod;
+std::vector<float> enemyLodDistances;
 
-    // Load shooting sound buffer
-    if (!shootBuffer.loadFromFile("resources/shoot.wav"))
-    {
-        std::cerr << "Error: Unable to load shooting sound effect.\n";
-        return false;
-    }
+// opaque draws of the frame, submitted sorted by shader, material and VAO
+RenderQueue renderQueue;
 
-    // Initialize shootSound with shootBuffer
-    shootSound.setBuffer(shootBuffer); // Assign the buffer to the sound
-    shootSound.setVolume(5.0f);        // Set desired volume
+// world bounding spheres tested against the view frustum each frame
+CullBatch cullBatch;
 
-    if (!explosionBuffer.loadFromFile("resources/explosion.wav"))
-    {
-        std::cerr << "Error: Unable to load explosion sound effect.\n";
-        return false;
-    }
-    explosionSound.setBuffer(explosionBuffer);
-    explosionSound.setVolume(5.0f); // Adjust volume as needed
+// explosions and the fighter's engine trail
+ParticleSystem particles;
+float engineTrailCarry = 0.0f;
 
-    std::cout << "Audio initialized successfully.\n";
-    return true;
-}
+// models use their coarsest level of detail whose error stays under this many pixels
+const float LOD_PIXEL_ERROR = 1.0f;
+bool useLod = true; // false with --no-lod
 
-void cleanupAudio()
-{
-    themeMusic.stop(); // Explicitly stop the music when exiting
-    // No explicit cleanup needed for `sf::Sound` or `sf::SoundBuffer` as SFML handles it internally
-}
+bool showStats = false; // draw-call / state-change overlay, toggled with F3
 
-// FUNÇÕES PARA TEXTO: initTextRendering e RenderText
-void initTextRendering(const std::string &fontPath)
+// offscreen session when running with --headless (null for the normal windowed game)
+HeadlessSession *headless = nullptr;
+bool headlessCloseRequested = false;
+
+void switchCameraPosition(glm::vec3 newPos, glm::vec3 newFront, bool followFighter, const glm::vec3 &fighterPos)
 {
-    // 1. Inicializa FreeType
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
+    if (followFighter)
     {
-        std::cerr << "ERRO: Não foi possível inicializar FreeType\n";
-        return;
+        // dynamically follow the fighter
+        camera.Position = fighterPos + newPos;
+        camera.Front = glm::normalize(glm::vec3(0.0f, 0.0f, 1.0f));
     }
-
-    // 2. Carrega a fonte
-    FT_Face face;
-    if (FT_New_Face(ft, fontPath.c_str(), 0, &face))
+    else
     {
-        std::cerr << "ERRO: Falha ao carregar a fonte: " << fontPath << std::endl;
-        FT_Done_FreeType(ft);
-        return;
+        camera.Position = newPos;
+        camera.Front = glm::normalize(newFront);
     }
 
-    // Define o tamanho que queremos em pixels (altura = 48)
-    FT_Set_Pixel_Sizes(face, 0, 48);
-
-    // Informa ao OpenGL que o alinhamento é de 1 byte
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // recalculate yaw and pitch
+    camera.Yaw = glm::atan(camera.Front.z, camera.Front.x);
+    camera.Pitch = glm::asin(camera.Front.y);
 
-    // 3. Para cada caractere ASCII imprimível, gera um glifo
-    for (unsigned char c = 0; c < 128; c++)
-    {
-        // Carrega o glifo
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cerr << "ERRO: Falha ao carregar glifo: " << (int)c << std::endl;
-            continue;
-        }
-        // Cria textura em OpenGL
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer);
-
-        // Configura parâmetros da textura
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // Armazena o caractere no map
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)};
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // 4. Limpa
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
-
-    // 5. Configura o VAO/VBO para renderizar texto
-    glGenVertexArrays(1, &textVAO);
-    glGenBuffers(1, &textVBO);
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    // 6 vértices (2 triângulos), cada vértice tem 4 floats (x, y, u, v)
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    // layout(location = 0) no text.vs
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    camera.Up = glm::normalize(glm::cross(glm::cross(camera.Front, glm::vec3(0.0f, 1.0f, 0.0f)), camera.Front));
+    cameraLocked = true;
 }
 
-void RenderText(Shader &s, std::string text, float x, float y, float scale, glm::vec3 color)
+// Window-system helpers: they go to GLFW normally and to the headless session
+// (scripted input, fixed clock, offscreen framebuffer) when one is running
+bool keyPressed(GLFWwindow *window, int key)
 {
-    // Ativa o shader de texto
-    s.use();
-    s.setVec3("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(textVAO);
-
-    // Para cada caractere na string
-    for (auto &c : text)
-    {
-        Character ch = Characters[c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-
-        // Cada caractere: 2 triângulos (6 vértices)
-        float vertices[6][4] = {
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos, ypos, 0.0f, 1.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-            {xpos + w, ypos + h, 1.0f, 0.0f}};
+    if (headless)
+        return headless->keyPressed(key);
+    return glfwGetKey(window, key) == GLFW_PRESS;
+}
 
-        // Render
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // Atualiza o buffer
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+double currentTime()
+{
+    if (headless)
+        return headless->time();
+    return glfwGetTime();
+}
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+void closeWindow(GLFWwindow *window)
+{
+    if (headless)
+        headlessCloseRequested = true;
+    else
+        glfwSetWindowShouldClose(window, true);
+}
 
-        // Avança o "cursor"
-        x += (ch.Advance >> 6) * scale;
-        // (ch.Advance >> 6) converte de 1/64 em pixels
-    }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+bool windowShouldClose(GLFWwindow *window)
+{
+    if (headless)
+        return headlessCloseRequested || headless->finished();
+    return glfwWindowShouldClose(window);
 }
 
-// Function to calculate group boundaries
-std::pair<float, float> calculateInitialGroupBoundaries(const std::vector<Enemy> &enemies)
+// Level of detail for a model centred at center, from how large it projects on screen
+size_t selectLod(const Model &model, const glm::vec3 &center, const glm::mat4 &projection)
 {
-    float minX = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::lowest();
+    if (!useLod)
+        return 0;
+    // pixels covered by one world unit at that distance
+    float distance = std::max(glm::length(center - camera.Position), 0.1f);
+    float pixelsPerUnit = projection[1][1] * SCR_HEIGHT * 0.5f / distance;
+    return model.selectLod(pixelsPerUnit, LOD_PIXEL_ERROR);
+}
 
-    for (const auto &enemy : enemies)
+// Squared camera distances at which model switches to each level of detail, for many copies
+void lodDistances(const Model &model, const glm::mat4 &projection, std::vector<float> &distances)
+{
+    if (!useLod)
     {
-        float x = std::get<0>(enemy.position);
-        if (x < minX)
-            minX = x;
-        if (x > maxX)
-            maxX = x;
+        distances.assign(1, 0.0f);
+        return;
     }
+    model.lodDistancesSquared(projection[1][1] * SCR_HEIGHT * 0.5f, LOD_PIXEL_ERROR, distances);
+}
 
-    return {minX, maxX};
+// Run ticks fixed ticks on a worker with the fighter steered by input; until
+// finishSimulation() only the job touches the simulation
+void startSimulation(const FighterInput &input, unsigned int ticks)
+{
+    float tickTime = timestep.tickTime();
+    jobSystem.run(simulationJob, [input, ticks, tickTime]()
+                  {
+        for (unsigned int tick = 0; tick < ticks && !simulation.gameOver; tick++)
+        {
+            simulationEvents.append(simulation.tick(tickTime, input));
+        } });
 }
 
-void switchCameraPosition(glm::vec3 newPos, glm::vec3 newFront, bool followFighter, const Model &fighter)
+// Wait for the ticks started last frame, then play their sounds and start their effects
+void finishSimulation()
 {
-    if (followFighter)
+    jobSystem.wait(simulationJob);
+
+    if (simulationEvents.shotsFired > 0)
     {
-        // dynamically follow the fighter
-        camera.Position = glm::vec3(std::get<0>(fighter.position), std::get<1>(fighter.position), std::get<2>(fighter.position)) + newPos;
-        camera.Front = glm::normalize(glm::vec3(0.0f, 0.0f, 1.0f));
+        playShootSound();
     }
-    else
+    if (simulationEvents.enemiesDestroyed > 0)
     {
-        camera.Position = newPos;
-        camera.Front = glm::normalize(newFront);
+        playExplosionSound();
+    }
+    for (const glm::vec3 &position : simulationEvents.destroyedAt)
+    {
+        particles.emitBurst(position, 1500, 2.0f, 12.0f, 0.5f, 1.3f, glm::vec3(1.0f, 0.9f, 0.5f), glm::vec3(1.0f, 0.3f, 0.05f), 0.35f);
     }
+    if (simulationEvents.playerHits > 0)
+    {
+        playExplosionSound();
+        particles.emitBurst(simulation.fighterPosition, 400, 1.0f, 6.0f, 0.3f, 0.8f, glm::vec3(1.0f), glm::vec3(0.3f, 0.5f, 1.0f), 0.2f);
 
-    // recalculate yaw and pitch
-    camera.Yaw = glm::atan(camera.Front.z, camera.Front.x);
-    camera.Pitch = glm::asin(camera.Front.y);
+        // Trigger the shaking effect
+        isShaking = true;
+        shakeTimer = shakeDuration;
+    }
 
-    camera.Up = glm::normalize(glm::cross(glm::cross(camera.Front, glm::vec3(0.0f, 1.0f, 0.0f)), camera.Front));
-    cameraLocked = true;
+    simulationEvents = SimulationEvents();
 }
 
-std::vector<Enemy> createEnemyGrid(const std::string &modelPath, std::tuple<float, float, float> centerPosition, int rows, int cols, float rowSpacing, float colSpacing)
+void presentFrame(GLFWwindow *window)
 {
-    std::vector<Enemy> enemies;
-
-    // Calculate the offset to center the grid around the centerPosition
-    float xOffset = -((cols - 1) * colSpacing) / 2.0f;
-    float zOffset = -((rows - 1) * rowSpacing) / 2.0f;
-
-    for (int row = 0; row < rows; ++row)
+    glState.endFrame();
+    if (headless)
     {
-        for (int col = 0; col < cols; ++col)
-        {
-            std::tuple<float, float, float> enemyPosition = std::make_tuple(
-                std::get<0>(centerPosition) + xOffset + col * colSpacing,
-                std::get<1>(centerPosition),
-                std::get<2>(centerPosition) + zOffset + row * rowSpacing);
-            enemies.emplace_back(modelPath, enemyPosition);
-        }
+        headless->endFrame(glState.lastFrame);
+        return;
     }
-    return enemies;
-}
-
-bool checkCollision(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &minB, const glm::vec3 &maxB)
-{
-    return (minA.x <= maxB.x && maxA.x >= minB.x) &&
-           (minA.y <= maxB.y && maxA.y >= minB.y) &&
-           (minA.z <= maxB.z && maxA.z >= minB.z);
+    glfwSwapBuffers(window);
+    glfwPollEvents();
 }
 
-int main()
+int main(int argc, char **argv)
 {
-    // glfw: initialize and configure
-    // ------------------------------
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    Config config;
+    if (!parseConfig(argc, argv, config))
+    {
+        return -1;
+    }
+    simulation.enemyFireRandom.reseed(config.seed, RANDOM_STREAM_ENEMY_FIRE);
+    shakeRandom.reseed(config.seed, RANDOM_STREAM_CAMERA_SHAKE);
+    particles.random.reseed(config.seed, RANDOM_STREAM_PARTICLES);
+    showStats = config.showStats;
+    useLod = !config.noLod;
+    packMeshVertices = !config.floatVertices;
+    timestep.setRate(config.tickRate);
+    jobSystem.start();
+
+    GLFWwindow *window = NULL;
+    HeadlessSession headlessSession(config.frames, config.captureDir, config.captureEvery, config.frameLog);
+
+    if (config.headless)
+    {
+        // offscreen context + framebuffer; also loads GL through glad
+        if (!headlessSession.init(SCR_WIDTH, SCR_HEIGHT))
+        {
+            headlessSession.destroy();
+            return -1;
+        }
+        headless = &headlessSession;
+    }
+    else
+    {
+        // glfw: initialize and configure
+        // ------------------------------
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    // glfw window creation
-    // --------------------
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Star Wars Scene", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+        // glfw window creation
+        // --------------------
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Star Wars Scene", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
 
-    // tell GLFW to capture our mouse
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        // tell GLFW to capture our mouse
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    // glad: load all OpenGL function pointers
-    // ---------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
+        // glad: load all OpenGL function pointers
+        // ---------------------------------------
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        loadGLExtensions((GLADloadproc)glfwGetProcAddress);
     }
 
+    // submit the scene with glMultiDrawElementsIndirect where the context supports it (GL 4.3)
+    renderQueue.indirect = glExtensions.multiDrawIndirect && !config.noIndirect;
+    std::cout << "Scene submission: " << (renderQueue.indirect ? "multi-draw indirect" : "per-draw") << std::endl;
+
     // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
     stbi_set_flip_vertically_on_load(true);
 
     // configure global opengl state
     // -----------------------------
-    glEnable(GL_DEPTH_TEST);
+    glState.setEnabled(GL_DEPTH_TEST, true);
 
-    // Load the theme song using SFML
+    // Load the theme song using SFML (headless runs have no audio device)
     // Initialize GLFW and other systems
-    if (!initializeAudio())
+    if (!config.headless && !initializeAudio())
     {
         return -1; // Exit if audio fails
     }
 
-    // Play the music and set it to loop
-    themeMusic.setLooping(true);
-    themeMusic.setVolume(50.0f); // Adjust volume as needed    themeMusic.play();
-
     // build and compile shaders
     // -------------------------
     Shader ourShader("shaders/lighting.vs", "shaders/lighting.fs");
     Shader skyboxShader("shaders/skybox.vs", "shaders/skybox.fs");
     Shader projectileShader("shaders/projectile.vs", "shaders/projectile.fs");
+    Shader particleShader("shaders/particle.vs", "shaders/particle.fs");
+
+    particles.init(ParticleSystem::DEFAULT_CAPACITY, config.cpuParticles ? ParticleSystem::Backend::Cpu : ParticleSystem::Backend::TransformFeedback);
+    std::cout << "Particles: " << (config.cpuParticles ? "CPU" : "transform feedback") << std::endl;
 
     // load models
     // -----------
@@ -407,23 +349,30 @@ int main()
 
     // Set up the projection matrix for text rendering
     glm::mat4 textProjection = glm::ortho(0.0f, static_cast<float>(SCR_WIDTH), 0.0f, static_cast<float>(SCR_HEIGHT));
-    textShader.use();
+    glState.useProgram(textShader.ID);
     textShader.setMat4("projection", textProjection);
 
     stbi_set_flip_vertically_on_load(false); // Set to false if enemies should not be flipped
 
     // Parameters for the enemy grid
     std::string enemyModelPath = "resources/invader1/invader.obj";
-    std::tuple<float, float, float> startPosition = std::make_tuple(55.0f, 0.0f, 0.0f);
+    glm::vec3 formationCenter = glm::vec3(55.0f, 0.0f, 0.0f);
     int rows = 3;
     int cols = 6;
     float rowSpacing = 7.0f;
     float colSpacing = 12.0f;
 
-    // Generate the enemies without movement parameters
-    std::vector<Enemy> enemies = createEnemyGrid(enemyModelPath, startPosition, rows, cols, rowSpacing, colSpacing);
+    // every invader looks the same, so they are all drawn with this one (from the snapshot's positions)
+    Enemy invaderModel(enemyModelPath);
+
+    // Fill the formation's slots with enemies
+    simulation.enemyBox = invaderModel.orientedBox;
+    simulation.reset(createFormationSlots(formationCenter, rows, cols, rowSpacing, colSpacing));
 
-    fighter1.position = make_tuple(4.5f, 0.0f, 0.0f);
+    // the fighter is drawn at 0.3 scale (its tilt rolls it at most 15 degrees; the hitbox ignores that)
+    fighter1.setOrientation(glm::scale(glm::mat4(1.0f), glm::vec3(0.3f)));
+    if (!fighter1.orientedBox.empty())
+        simulation.fighterBox = fighter1.orientedBox;
 
     stbi_set_flip_vertically_on_load(false);
 
@@ -436,63 +385,10 @@ int main()
         "resources/skybox 2/back.png"};
     unsigned int cubemapTexture = loadCubemap(faces);
 
-    float skyboxVertices[] = {
-        // positions
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-
-        -1.0f, -1.0f, 1.0f,
-        -1.0f, -1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, 1.0f,
-        -1.0f, -1.0f, 1.0f,
-
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-
-        -1.0f, -1.0f, 1.0f,
-        -1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, -1.0f, 1.0f,
-        -1.0f, -1.0f, 1.0f,
-
-        -1.0f, 1.0f, -1.0f,
-        1.0f, 1.0f, -1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        -1.0f, 1.0f, 1.0f,
-        -1.0f, 1.0f, -1.0f,
-
-        -1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f, 1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f, 1.0f,
-        1.0f, -1.0f, 1.0f};
-
-    std::pair<float, float> boundaries = calculateInitialGroupBoundaries(enemies);
-    float groupMinX = boundaries.first;
-    float groupMaxX = boundaries.second;
-
     // skybox VAO
-    unsigned int skyboxVAO, skyboxVBO;
-    glGenVertexArrays(1, &skyboxVAO);
-    glGenBuffers(1, &skyboxVBO);
-    glBindVertexArray(skyboxVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    unsigned int skyboxVAO = createSkyboxVAO();
+    glState.useProgram(skyboxShader.ID);
+    skyboxShader.setInt("skybox", 0);
 
     // draw in wireframe
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -502,8 +398,18 @@ int main()
 
     // render loop
     // -----------
-    while (!glfwWindowShouldClose(window))
+    while (!windowShouldClose(window))
     {
+        // per-frame time logic (kept up to date on the menus too, so the game
+        // does not try to catch up with the time spent on them)
+        // --------------------
+        double currentFrame = currentTime();
+        deltaTime = static_cast<float>(currentFrame - lastFrame);
+        lastFrame = currentFrame;
+
+        // nothing below touches the simulation before the last frame's ticks are done
+        finishSimulation();
+
         // Check if the game is in the start screen state
         if (showStartScreen)
         {
@@ -511,11 +417,10 @@ int main()
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Black background
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            textShader.use();
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.setEnabled(GL_BLEND, true);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-            glDisable(GL_DEPTH_TEST); // Disable depth testing for text rendering
+            glState.setEnabled(GL_DEPTH_TEST, false); // Disable depth testing for text rendering
 
             // Render "Space Invaders" Title
             RenderText(textShader, "Space Invaders", 50.0f, 150.0f, 2.0f, glm::vec3(0.0f, 1.0f, 0.0f));
@@ -523,27 +428,26 @@ int main()
             // Render Instructions
             RenderText(textShader, "Press Space to Start", 50.0f, 100.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             RenderText(textShader, "Press ESC to Exit", 50.0f, 50.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-            glEnable(GL_DEPTH_TEST); // Re-enable depth testing for subsequent rendering
+            glState.setEnabled(GL_DEPTH_TEST, true); // Re-enable depth testing for subsequent rendering
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            presentFrame(window);
 
             // Check for input to start the game
-            if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_SPACE))
             {
                 showStartScreen = false; // Hide the start screen
             }
 
             // Allow exiting from the start screen
-            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_ESCAPE))
             {
-                glfwSetWindowShouldClose(window, true);
+                closeWindow(window);
             }
 
             continue; // Skip the rest of the loop until the game starts
         }
 
-        if (enemies.empty())
+        if (simulation.formation.empty())
         {
             victory = true;
         }
@@ -554,37 +458,26 @@ int main()
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Black background
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            textShader.use();
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.setEnabled(GL_BLEND, true);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-            glDisable(GL_DEPTH_TEST); // Disable depth testing for text rendering
+            glState.setEnabled(GL_DEPTH_TEST, false); // Disable depth testing for text rendering
             RenderText(textShader, "Victory!", 50.0f, 150.0f, 2.0f, glm::vec3(0.0f, 1.0f, 0.0f));
             RenderText(textShader, "Press Space to Restart", 50.0f, 100.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             RenderText(textShader, "Press ESC to Exit", 50.0f, 50.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-            glEnable(GL_DEPTH_TEST); // Re-enable depth testing for subsequent rendering
+            glState.setEnabled(GL_DEPTH_TEST, true); // Re-enable depth testing for subsequent rendering
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            presentFrame(window);
 
-            if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_SPACE))
             {
                 victory = false;
-                // Reset game variables
-                score = 0;
-                playerLives = 3;
-                gameOver = false;
-
-                // Clear enemies and projectiles
-                enemies.clear();
-                projectiles.clear();
-                enemyProjectiles.clear();
-
-                // Reinitialize enemies
-                enemies = createEnemyGrid(enemyModelPath, startPosition, rows, cols, rowSpacing, colSpacing);
+                // Reset game variables, the fighter, enemies and projectiles, and drop the time
+                // the last game had not yet ticked
+                simulation.reset(createFormationSlots(formationCenter, rows, cols, rowSpacing, colSpacing));
+                timestep.reset();
 
-                // Reset player position
-                fighter1.position = make_tuple(4.5f, 0.0f, 0.0f);
+                particles.clear();
 
                 // Reset camera
                 camera.Position = cameraPos2;
@@ -593,51 +486,40 @@ int main()
                 continue; // Skip the rest of the loop for this frame
             }
 
-            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_ESCAPE))
             {
-                glfwSetWindowShouldClose(window, true);
+                closeWindow(window);
                 continue;
             }
 
             continue; // Skip the rest of the game logic when in victory state
         }
 
-        if (gameOver)
+        if (simulation.gameOver)
         {
             // Render the "Game Over" screen
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            textShader.use();
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.setEnabled(GL_BLEND, true);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-            glDisable(GL_DEPTH_TEST);
+            glState.setEnabled(GL_DEPTH_TEST, false);
             RenderText(textShader, "Game Over", 50.0f, 150.0f, 2.0f, glm::vec3(0.0f, 1.0f, 0.0f));
             RenderText(textShader, "Press Space to Restart", 50.0f, 100.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             RenderText(textShader, "Press ESC to Exit", 50.0f, 50.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-            glEnable(GL_DEPTH_TEST);
+            glState.setEnabled(GL_DEPTH_TEST, true);
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            presentFrame(window);
 
-            if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_SPACE))
             {
-                // Reset game variables
-                score = 0;
-                playerLives = 3;
-                gameOver = false;
+                // Reset game variables, the fighter, enemies and projectiles, and drop the time
+                // the last game had not yet ticked
+                simulation.reset(createFormationSlots(formationCenter, rows, cols, rowSpacing, colSpacing));
+                timestep.reset();
 
-                // Clear enemies and projectiles
-                enemies.clear();
-                projectiles.clear();
-                enemyProjectiles.clear();
-
-                // Reinitialize enemies
-                enemies = createEnemyGrid(enemyModelPath, startPosition, rows, cols, rowSpacing, colSpacing);
-
-                // Reset player position
-                fighter1.position = make_tuple(4.5f, 0.0f, 0.0f);
+                particles.clear();
 
                 // Reset camera
                 camera.Position = cameraPos2;
@@ -646,36 +528,25 @@ int main()
                 continue; // Skip the rest of the loop for this frame
             }
 
-            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            if (keyPressed(window, GLFW_KEY_ESCAPE))
             {
-                glfwSetWindowShouldClose(window, true);
+                closeWindow(window);
                 continue;
             }
 
             continue; // Skip the rest of the game logic when gameOver is true
         }
-        // per-frame time logic
-        // --------------------
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-        // Set material properties (if applicable)
-        ourShader.setFloat("material.shininess", 32.0f); // Adjust shininess for the material
-
-        // Pass camera position to the shader
-        ourShader.setVec3("viewPos", camera.Position);
-
-        skyboxShader.use();
-        skyboxShader.setInt("skybox", 0);
-
         // input
         // -----
-        processInput(window, fighter1);
+        processInput(window);
 
-        if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_P))
             play1 = true;
 
-        ourShader.use();
+        glState.useProgram(ourShader.ID);
+
+        // Set material properties (if applicable)
+        ourShader.setFloat("material.shininess", 32.0f); // Adjust shininess for the material
 
         // lighting settings
         lightPos = camera.Position;
@@ -692,55 +563,21 @@ int main()
         glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // don't forget to enable shader before setting uniforms
-        ourShader.use();
+        // how far the finished ticks' state lies between their last two ticks; everything
+        // the game moves is drawn there, from copies, while the next ticks run
+        float alpha = timestep.alpha();
+        simulation.takeSnapshot(snapshot);
+        glm::vec3 fighterDrawPos = glm::mix(snapshot.fighterPrevious, snapshot.fighterPosition, alpha);
+        float fighterDrawTilt = glm::mix(snapshot.fighterPreviousTilt, snapshot.fighterTilt, alpha);
 
-        // Check collisions
-        for (auto enemyIt = enemies.begin(); enemyIt != enemies.end();)
-        {
-            bool enemyHit = false;
+        // advance the game by as many fixed ticks as this frame's time covers, on a worker:
+        // fighter movement, collisions, enemy movement and fire, projectiles
+        startSimulation(readFighterInput(window), timestep.advance(deltaTime));
 
-            for (auto projIt = projectiles.begin(); projIt != projectiles.end();)
-            {
-                if (checkCollision(
-                        (*enemyIt).getBoundingBoxMin(), (*enemyIt).getBoundingBoxMax(),
-                        (*projIt).getBoundingBoxMin(), (*projIt).getBoundingBoxMax()))
-                {
-                    // Remove the projectile
-                    projIt = projectiles.erase(projIt);
-                    enemyHit = true;
-                    explosionSound.play();
-                    break; // Stop checking other projectiles for this enemy
-                }
-                else
-                {
-                    ++projIt;
-                }
-            }
-
-            if (enemyHit)
-            {
-                // Increment score
-                score += 100; // Assign points per enemy, adjust as needed
-
-                // Remove the enemy
-                enemyIt = enemies.erase(enemyIt);
-            }
-            else
-            {
-                ++enemyIt;
-            }
-        }
-
-        // Check if any invader has reached the losing position (e.g., 10.0f)
-        for (const auto &enemy : enemies)
-        {
-            if (std::get<0>(enemy.position) <= 12.5f) // Assuming Z-axis for forward movement
-            {
-                std::cout << "An invader reached the player! Game Over!" << std::endl;
-                gameOver = true;
-            }
-        }
+        // engine exhaust from the back of the fighter, then advance every particle
+        particles.emitTrail(fighterDrawPos + glm::vec3(simulation.fighterBox.min.x, 0.0f, 0.0f), glm::vec3(-8.0f, 0.0f, 0.0f), 400.0f, deltaTime,
+                            engineTrailCarry, 0.4f, glm::vec3(0.4f, 0.7f, 1.0f), 0.12f);
+        particles.update(glState, deltaTime);
 
         // view/projection transformations
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
@@ -748,100 +585,17 @@ int main()
         ourShader.setMat4("projection", projection);
         ourShader.setMat4("view", view);
 
-        projectileShader.use();
+        glState.useProgram(projectileShader.ID);
         projectileShader.setMat4("projection", projection);
         projectileShader.setMat4("view", view);
-        projectileShader.setVec3("materialColor", glm::vec3(1.0f, 0.0f, 0.0f)); // Bright Red
-        projectileShader.setVec3("emissionColor", glm::vec3(0.5f, 0.1f, 0.1f)); // Slight Glow
-
-        glBindVertexArray(Projectile::VAO);
-
-        // Rendering projectiles
-        for (auto &projectile : projectiles)
-        {
-            if (projectile.active)
-            {
-                projectile.update(deltaTime); // This should move the projectile
-                projectileShader.use();
-
-                // Set matrices
-                projectileShader.setMat4("projection", projection);
-                projectileShader.setMat4("view", view);
-
-                // Set colors
-                projectileShader.setVec3("materialColor", glm::vec3(1.0f, 0.0f, 0.0f));
-                projectileShader.setVec3("emissionColor", glm::vec3(0.5f, 0.1f, 0.1f));
-
-                // Set model matrix
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, projectile.position);
-                model = glm::scale(model, glm::vec3(0.1f));
-                projectileShader.setMat4("model", model);
-
-                // Render projectile
-                projectile.Draw(projectileShader);
-            }
-        }
-
-        ourShader.use();
-
-        // Update enemy positions using group-based movement
-        // Step 1: Check if the group is about to exceed boundaries
-        bool boundaryReached = false;
-
-        if ((enemyDirection == 1 && groupMaxX + enemyMoveSpeed * deltaTime > enemyBoundaryRight) ||
-            (enemyDirection == -1 && groupMinX - enemyMoveSpeed * deltaTime < enemyBoundaryLeft))
-        {
-            boundaryReached = true;
-        }
-
-        if (boundaryReached)
-        {
-            // Change direction and move the group down
-            enemyDirection *= -1;
-            for (auto &enemy : enemies)
-            {
-                enemy.moveDown(enemyMoveDownDistance);
-            }
-
-            // Update group boundaries after moving down
-            // (Assuming enemies only move horizontally and down)
-        }
-        else
-        {
-            // Move the group horizontally
-            float deltaX = enemyDirection * enemyMoveSpeed * deltaTime;
-            for (auto &enemy : enemies)
-            {
-                enemy.moveHorizontally(deltaX);
-            }
-
-            // Update group boundaries based on movement
-            groupMinX += enemyDirection * enemyMoveSpeed * deltaTime;
-            groupMaxX += enemyDirection * enemyMoveSpeed * deltaTime;
-        }
-
-        // Render enemies
-        for (auto &enemy : enemies)
-        {
-            glm::mat4 enemyModel = glm::mat4(1.0f);
-            enemyModel = glm::translate(enemyModel, glm::vec3(
-                                                        std::get<0>(enemy.position),
-                                                        std::get<1>(enemy.position),
-                                                        std::get<2>(enemy.position)));
-            enemyModel = glm::rotate(enemyModel, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            enemyModel = glm::scale(enemyModel, glm::vec3(2.6f, 2.6f, 2.6f));
-            ourShader.setMat4("model", enemyModel);
-            enemy.Draw(ourShader);
-        }
 
         // Apply shaking effect if active
         glm::vec3 shakeOffset(0.0f, 0.0f, 0.0f);
         if (isShaking)
         {
             // Generate random offsets for the shake
-            shakeOffset.x = ((rand() % 100) / 100.0f - 0.5f) * shakeIntensity;
-            shakeOffset.y = ((rand() % 100) / 100.0f - 0.5f) * shakeIntensity;
+            shakeOffset.x = shakeRandom.range(-0.5f, 0.5f) * shakeIntensity;
+            shakeOffset.y = shakeRandom.range(-0.5f, 0.5f) * shakeIntensity;
 
             // Decrease the shake timer
             shakeTimer -= deltaTime;
@@ -851,113 +605,88 @@ int main()
             }
         }
 
-        // Render the fighter1 model
+        // Model matrix of the fighter1 model
         glm::mat4 fighter1Model = glm::mat4(1.0f);
-        fighter1Model = glm::translate(fighter1Model, glm::vec3(
-                                                          get<0>(fighter1.position) + shakeOffset.x,
-                                                          get<1>(fighter1.position) + shakeOffset.y,
-                                                          get<2>(fighter1.position)));
-        fighter1Model = glm::rotate(fighter1Model, glm::radians(fighterTiltAngle), glm::vec3(1.0f, 0.0f, 0.0f));
+        fighter1Model = glm::translate(fighter1Model, fighterDrawPos + glm::vec3(shakeOffset.x, shakeOffset.y, 0.0f));
+        fighter1Model = glm::rotate(fighter1Model, glm::radians(fighterDrawTilt), glm::vec3(1.0f, 0.0f, 0.0f));
         fighter1Model = glm::scale(fighter1Model, glm::vec3(0.3f, 0.3f, 0.3f));
-        ourShader.setMat4("model", fighter1Model);
-        fighter1.Draw(ourShader);
 
-        // Enemy shooting logic
-        static float enemyShootCooldown = 1.0f; // Cooldown period for enemies (in seconds)
-        static float enemyShootTimer = 0.0f;
+        // Frustum culling: world bounding spheres of everything below, tested in one batch
+        // (added in the same order as they are submitted)
+        size_t enemyCount = snapshot.enemyPositions.size();
+        enemyDrawPositions.resize(enemyCount);
+        for (size_t e = 0; e < enemyCount; e++)
+        {
+            enemyDrawPositions[e] = glm::mix(snapshot.enemyPrevious[e], snapshot.enemyPositions[e], alpha);
+        }
 
-        if (enemyShootTimer > 0.0f)
-            enemyShootTimer -= deltaTime;
+        cullBatch.clear();
+        for (size_t p = 0; p < snapshot.projectiles.size(); p++)
+        {
+            cullBatch.add(snapshot.projectiles.getBoundingSphere(p, alpha));
+        }
+        cullBatch.add(invaderModel.orientedBounds, enemyDrawPositions.data(), enemyCount);
+        cullBatch.add(transformSphere(fighter1.bounds, fighter1Model));
+        for (size_t p = 0; p < snapshot.enemyProjectiles.size(); p++)
+        {
+            cullBatch.add(snapshot.enemyProjectiles.getBoundingSphere(p, alpha));
+        }
+        cullBatch.cull(Frustum(projection * view));
+        glState.frame.objectsVisible += cullBatch.visibleCount();
+        glState.frame.objectsCulled += static_cast<unsigned int>(cullBatch.size()) - cullBatch.visibleCount();
 
-        if (enemyShootTimer <= 0.0f)
+        // Queue the visible projectiles, enemies and the fighter; the queue draws them sorted by shader, material and VAO
+        size_t cullIndex = 0;
+        for (size_t p = 0; p < snapshot.projectiles.size(); p++)
         {
-            // Randomly pick an enemy to shoot
-            if (!enemies.empty())
+            if (cullBatch.isVisible(cullIndex++))
             {
-                int randomEnemyIndex = rand() % enemies.size();
-                const Enemy &shootingEnemy = enemies[randomEnemyIndex];
-
-                // Calculate shooting direction towards the player's line of movement
-                glm::vec3 enemyPos = glm::vec3(
-                    std::get<0>(shootingEnemy.position),
-                    std::get<1>(shootingEnemy.position),
-                    std::get<2>(shootingEnemy.position));
-
-                glm::vec3 playerLineDirection = glm::normalize(glm::vec3(1.0f, 0.0f, 0.0f)); // Replace this with player's movement direction
-
-                // Create the enemy projectile
-                glm::vec3 projectileVelocity = -playerLineDirection * 20.0f; // Negative for opposite direction
-                enemyProjectiles.emplace_back(enemyPos, projectileVelocity);
+                snapshot.projectiles.Submit(p, renderQueue, projectileShader, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.5f, 0.1f, 0.1f), alpha); // Bright red, slight glow
             }
-
-            // Reset the timer
-            enemyShootTimer = enemyShootCooldown;
         }
 
-        // Update and render enemy projectiles
-        for (auto it = enemyProjectiles.begin(); it != enemyProjectiles.end();)
+        // Render enemies: the visible ones sorted into levels of detail by distance, then one
+        // instance run per level, whose matrices the flush builds straight into the instance buffer
+        lodDistances(invaderModel, projection, enemyLodDistances);
+        enemiesByLod.resize(enemyLodDistances.size());
+        for (std::vector<uint32_t> &enemies : enemiesByLod)
         {
-            if (it->active)
-            {
-                it->update(deltaTime); // Update projectile position
-
-                // Set up shader and transformations
-                projectileShader.use();
-                projectileShader.setMat4("projection", projection);
-                projectileShader.setMat4("view", view);
-                projectileShader.setVec3("materialColor", glm::vec3(0.0f, 1.0f, 0.0f)); // Enemy projectile color
-                projectileShader.setVec3("emissionColor", glm::vec3(0.1f, 0.5f, 0.1f)); // Enemy projectile glow
-
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, it->position);
-                model = glm::scale(model, glm::vec3(0.1f));
-                projectileShader.setMat4("model", model);
-
-                // Render the projectile
-                it->Draw(projectileShader);
-
-                ++it;
-            }
-            else
+            enemies.clear();
+        }
+        for (size_t e = 0; e < enemyCount; e++)
+        {
+            if (cullBatch.isVisible(cullIndex++))
             {
-                // Remove inactive projectiles
-                it = enemyProjectiles.erase(it);
+                glm::vec3 offset = enemyDrawPositions[e] + invaderModel.orientedBounds.center - camera.Position;
+                float distanceSquared = glm::dot(offset, offset);
+                size_t lod = 0;
+                while (lod + 1 < enemyLodDistances.size() && distanceSquared >= enemyLodDistances[lod + 1])
+                    lod++;
+                enemiesByLod[lod].push_back(static_cast<uint32_t>(e));
             }
         }
+        for (size_t lod = 0; lod < enemiesByLod.size(); lod++)
+        {
+            invaderModel.SubmitInstances(renderQueue, ourShader, enemyDrawPositions.data(), enemiesByLod[lod].data(), enemiesByLod[lod].size(), lod);
+        }
 
-        // Check collisions between player and enemy projectiles
-        for (auto it = enemyProjectiles.begin(); it != enemyProjectiles.end();)
+        // Render the fighter1 model
+        if (cullBatch.isVisible(cullIndex++))
         {
-            glm::vec3 playerMin = glm::vec3(std::get<0>(fighter1.position) - 2.0f, std::get<1>(fighter1.position) - 2.0f, std::get<2>(fighter1.position) - 2.0f);
-            glm::vec3 playerMax = glm::vec3(std::get<0>(fighter1.position) + 2.0f, std::get<1>(fighter1.position) + 2.0f, std::get<2>(fighter1.position) + 2.0f);
+            fighter1.Submit(renderQueue, ourShader, fighter1Model, selectLod(fighter1, fighterDrawPos + fighter1.orientedBounds.center, projection));
+        }
 
-            if (checkCollision(playerMin, playerMax, it->getBoundingBoxMin(), it->getBoundingBoxMax()))
-            {
-                // Player is hit
-                explosionSound.play();
-                playerLives--;
-                std::cout << "Player hit! Lives remaining: " << playerLives << std::endl;
-
-                // Trigger the shaking effect
-                isShaking = true;
-                shakeTimer = shakeDuration;
-
-                // Remove the projectile
-                it = enemyProjectiles.erase(it);
-
-                // Check if the game should end
-                if (playerLives <= 0)
-                {
-                    std::cout << "Game Over! Player ran out of lives." << std::endl;
-                    gameOver = true; // Set the game over flag
-                }
-            }
-            else
+        // Render enemy projectiles
+        for (size_t p = 0; p < snapshot.enemyProjectiles.size(); p++)
+        {
+            if (cullBatch.isVisible(cullIndex++))
             {
-                ++it;
+                snapshot.enemyProjectiles.Submit(p, renderQueue, projectileShader, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.1f, 0.5f, 0.1f), alpha); // Enemy projectile color and glow
             }
         }
 
+        renderQueue.flush(glState);
+
         // render the hangar model
         // glm::mat4 hangarModel = glm::mat4(1.0f);
         // hangarModel = glm::translate(hangarModel, glm::vec3(-30.0f, 0.0f, 0.0f)); // translate it down so it's at the center of the scene
@@ -965,47 +694,55 @@ int main()
         // ourShader.setMat4("model", hangarModel);
         // hangar.Draw(ourShader);
 
-        glDepthFunc(GL_LEQUAL);
-        skyboxShader.use();
+        glState.depthFunc(GL_LEQUAL);
+        glState.useProgram(skyboxShader.ID);
         view = glm::mat4(glm::mat3(camera.GetViewMatrix()));
         skyboxShader.setMat4("view", view);
         skyboxShader.setMat4("projection", projection);
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glDepthFunc(GL_LESS); // Set depth function back to default
+        glState.bindVertexArray(skyboxVAO);
+        glState.bindTexture(0, GL_TEXTURE_CUBE_MAP, cubemapTexture);
+        glState.drawArrays(GL_TRIANGLES, 0, 36);
+        glState.depthFunc(GL_LESS); // Set depth function back to default
 
-        // Render the score
-        textShader.use();
+        // particles last: they blend over the scene and the skybox
+        particles.draw(glState, particleShader, camera.GetViewMatrix(), projection, static_cast<float>(SCR_HEIGHT));
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // Render the score
+        glState.setEnabled(GL_BLEND, true);
+        glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glDisable(GL_DEPTH_TEST); // Disable depth testing for text rendering
-        RenderText(textShader, "Score: " + std::to_string(score), 25.0f, SCR_HEIGHT - 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-        RenderText(textShader, "Lives: " + std::to_string(playerLives), SCR_WIDTH - 450.0f, SCR_HEIGHT - 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
-        glEnable(GL_DEPTH_TEST); // Re-enable depth testing for subsequent rendering
+        glState.setEnabled(GL_DEPTH_TEST, false); // Disable depth testing for text rendering
+        RenderText(textShader, "Score: " + std::to_string(snapshot.score), 25.0f, SCR_HEIGHT - 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+        RenderText(textShader, "Lives: " + std::to_string(snapshot.playerLives), SCR_WIDTH - 450.0f, SCR_HEIGHT - 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+        if (showStats)
+        {
+            // counters of the previous frame (this one is still being drawn)
+            const RenderStats &stats = glState.lastFrame;
+            RenderText(textShader, "Draws: " + std::to_string(stats.drawCalls) + "  State changes: " + std::to_string(stats.stateChanges) + "  Triangles: " + std::to_string(stats.triangles), 25.0f, 25.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            RenderText(textShader, "Visible: " + std::to_string(stats.objectsVisible) + "  Culled: " + std::to_string(stats.objectsCulled) + "  Particles: " + std::to_string(stats.particles), 25.0f, 50.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        }
+        glState.setEnabled(GL_DEPTH_TEST, true); // Re-enable depth testing for subsequent rendering
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        presentFrame(window);
     }
 
     // After the main loop and before glfwTerminate()
+    jobSystem.wait(simulationJob);
+    jobSystem.stop();
 
-    if (Projectile::VAO != 0)
-    {
-        glDeleteVertexArrays(1, &Projectile::VAO);
-    }
-    if (Projectile::VBO != 0)
-    {
-        glDeleteBuffers(1, &Projectile::VBO);
-    }
-    if (Projectile::EBO != 0)
+    renderQueue.destroy();
+    particles.destroy();
+    meshArena.destroy();
+    packedMeshArena.destroy();
+
+    if (headless)
     {
-        glDeleteBuffers(1, &Projectile::EBO);
+        headless->finish();
+        headless->destroy();
+        headless = nullptr;
+        return 0;
     }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
@@ -1017,14 +754,14 @@ int main()
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow *window, Model &fighter1)
+void processInput(GLFWwindow *window)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    if (keyPressed(window, GLFW_KEY_ESCAPE))
+        closeWindow(window);
 
     // Toggle camera lock when pressing the "L" key
     static bool lKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
+    if (keyPressed(window, GLFW_KEY_L))
     {
         if (!lKeyPressed)
         {
@@ -1037,196 +774,50 @@ void processInput(GLFWwindow *window, Model &fighter1)
         lKeyPressed = false;
     }
 
-    // Switch camera positions based on key input
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+    // Toggle the render stats overlay with F3
+    static bool f3KeyPressed = false;
+    if (keyPressed(window, GLFW_KEY_F3))
     {
-        switchCameraPosition(cameraPos1, cameraFront1, false, fighter1);
-    }
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
-    {
-        switchCameraPosition(cameraPos2, cameraFront2, false, fighter1);
+        if (!f3KeyPressed)
+        {
+            showStats = !showStats;
+            f3KeyPressed = true;
+        }
     }
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+    else
     {
-        switchCameraPosition(cameraPos3, cameraFront3, false, fighter1);
+        f3KeyPressed = false;
     }
 
-    // Handle shooting projectiles with 'V' key
-    static bool vKeyPressedLastFrame = false;
-    static float shootCooldown = 0.5f; // Cooldown period in seconds
-    static float shootTimer = 0.0f;
-
-    if (shootTimer > 0.0f)
-        shootTimer -= deltaTime;
-
-    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS)
+    // Switch camera positions based on key input
+    if (keyPressed(window, GLFW_KEY_1))
     {
-        if (!vKeyPressedLastFrame && shootTimer <= 0.0f)
-        {
-            vKeyPressedLastFrame = true;
-
-            // Define the projectile's initial position (e.g., in front of the fighter)
-            glm::vec3 fighterPos = glm::vec3(get<0>(fighter1.position), get<1>(fighter1.position), get<2>(fighter1.position));
-            glm::vec3 fixedForwardDir = glm::vec3(1.0f, 0.0f, 0.0f);            // Fixed forward direction (e.g., negative Z-axis)
-            glm::vec3 projectileStartPos = fighterPos + fixedForwardDir * 1.0f; // Adjust offset as needed
-
-            // Define the projectile's velocity (e.g., forward direction)
-            float projectileSpeed = 50.0f; // Adjust speed as needed
-            glm::vec3 projectileVelocity = fixedForwardDir * projectileSpeed;
-
-            // Create and add the new projectile to the container
-            projectiles.emplace_back(projectileStartPos, projectileVelocity);
-
-            // Reset the cooldown timer
-            shootTimer = shootCooldown;
-
-            // Play the shooting sound effect
-            shootSound.play();
-        }
+        switchCameraPosition(cameraPos1, cameraFront1, false, simulation.fighterPosition);
     }
-    else
+    if (keyPressed(window, GLFW_KEY_2))
     {
-        vKeyPressedLastFrame = false;
+        switchCameraPosition(cameraPos2, cameraFront2, false, simulation.fighterPosition);
     }
-
-    // Variables for fighter movement
-    static float fighterVelocity = 0.0f;
-    static float fighterAcceleration = 10.0f;
-    static float fighterMaxSpeed = 5.0f;
-    static float fighterDamping = 5.0f;
-
-    // Tilt variables
-    static float maxTiltAngle = 15.0f;
-    static float tiltSpeed = 5.0f;
-
-    // Different boundaries for each camera position
-    static float fighterMinXPos1 = -5.0f;
-    static float fighterMaxXPos1 = 5.0f;
-
-    static float fighterMinXPos2 = -10.0f;
-    static float fighterMaxXPos2 = 10.0f;
-
-    static float fighterMinXPos3 = -7.0f;
-    static float fighterMaxXPos3 = 7.0f;
-
-    // Movement for the 3 camera positions
-    if (camera.Position == cameraPos1 || camera.Position == cameraPos2 || camera.Position == cameraPos3)
+    if (keyPressed(window, GLFW_KEY_3))
     {
-        float targetTiltAngle = 0.0f;
-        bool isMoving = false;
-        bool atBoundary = false;
-
-        // Check for movement and determine target tilt angle
-        if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS)
-        {
-            isMoving = true;
-            targetTiltAngle = -maxTiltAngle;
-            fighterVelocity -= fighterAcceleration * deltaTime;
-        }
-        else if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS)
-        {
-            isMoving = true;
-            targetTiltAngle = maxTiltAngle;
-            fighterVelocity += fighterAcceleration * deltaTime;
-        }
-        else
-        {
-            // Gradually reduce velocity when no key is pressed
-            if (fighterVelocity > 0.0f)
-            {
-                fighterVelocity -= fighterDamping * deltaTime;
-                if (fighterVelocity < 0.0f)
-                    fighterVelocity = 0.0f;
-            }
-            else if (fighterVelocity < 0.0f)
-            {
-                fighterVelocity += fighterDamping * deltaTime;
-                if (fighterVelocity > 0.0f)
-                    fighterVelocity = 0.0f;
-            }
-        }
-
-        // Clamp velocity to maximum speed
-        fighterVelocity = glm::clamp(fighterVelocity, -fighterMaxSpeed, fighterMaxSpeed);
-
-        // Update fighter position
-        std::get<2>(fighter1.position) += fighterVelocity * deltaTime;
-
-        // Apply different boundaries based on the camera position
-        if (camera.Position == cameraPos1)
-        {
-            if (std::get<2>(fighter1.position) < fighterMinXPos1)
-            {
-                std::get<2>(fighter1.position) = fighterMinXPos1;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-            if (std::get<2>(fighter1.position) > fighterMaxXPos1)
-            {
-                std::get<2>(fighter1.position) = fighterMaxXPos1;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-        }
-        else if (camera.Position == cameraPos2)
-        {
-            if (std::get<2>(fighter1.position) < fighterMinXPos2)
-            {
-                std::get<2>(fighter1.position) = fighterMinXPos2;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-            if (std::get<2>(fighter1.position) > fighterMaxXPos2)
-            {
-                std::get<2>(fighter1.position) = fighterMaxXPos2;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-        }
-        else if (camera.Position == cameraPos3)
-        {
-            if (std::get<2>(fighter1.position) < fighterMinXPos3)
-            {
-                std::get<2>(fighter1.position) = fighterMinXPos3;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-            if (std::get<2>(fighter1.position) > fighterMaxXPos3)
-            {
-                std::get<2>(fighter1.position) = fighterMaxXPos3;
-                fighterVelocity = 0.0f;
-                atBoundary = true;
-            }
-        }
-
-        // Smoothly interpolate the tilt angle
-        if (isMoving)
-        {
-            // Apply tilt based on movement
-            fighterTiltAngle = glm::mix(fighterTiltAngle, targetTiltAngle, tiltSpeed * deltaTime);
-        }
-        else if (!atBoundary)
-        {
-            // Reset tilt to 0 only if not at boundary
-            fighterTiltAngle = glm::mix(fighterTiltAngle, 0.0f, tiltSpeed * deltaTime);
-        }
+        switchCameraPosition(cameraPos3, cameraFront3, false, simulation.fighterPosition);
     }
 
     // Process camera movement only if the camera is not locked
     if (!cameraLocked)
     {
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_W))
             camera.ProcessKeyboard(FORWARD, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_S))
             camera.ProcessKeyboard(BACKWARD, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_A))
             camera.ProcessKeyboard(LEFT, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_D))
             camera.ProcessKeyboard(RIGHT, deltaTime);
         // Removed Space key handling for camera movement
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_SPACE))
             camera.ProcessKeyboard(UP, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+        if (keyPressed(window, GLFW_KEY_LEFT_SHIFT))
             camera.ProcessKeyboard(DOWN, deltaTime);
     }
 
@@ -1235,6 +826,23 @@ void processInput(GLFWwindow *window, Model &fighter1)
     std::cout << "Camera Front: (" << camera.Front.x << ", " << camera.Front.y << ", " << camera.Front.z << ")" << std::endl;
 }
 
+// read the fighter's keys (and which predefined camera is active) for this frame's ticks
+// -------------------------------------------------------------------------------------
+FighterInput readFighterInput(GLFWwindow *window)
+{
+    FighterInput input;
+    input.left = keyPressed(window, GLFW_KEY_Z);
+    input.right = keyPressed(window, GLFW_KEY_X);
+    input.fire = keyPressed(window, GLFW_KEY_V);
+    if (camera.Position == cameraPos1)
+        input.cameraPreset = 1;
+    else if (camera.Position == cameraPos2)
+        input.cameraPreset = 2;
+    else if (camera.Position == cameraPos3)
+        input.cameraPreset = 3;
+    return input;
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
@@ -1281,33 +889,3 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
-
-unsigned int loadCubemap(vector<std::string> faces)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
-    {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return textureID;
-}
@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;       // Vertex position
 layout (location = 1) in vec3 aNormal;    // Vertex normal
 layout (location = 2) in vec2 aTexCoords; // Texture coordinates
+layout (location = 3) in mat4 aInstanceModel; // Per-instance model matrix (indirect submission)
 
 // Interface block to pass data to the fragment shader
 out VS_OUT {
@@ -13,15 +14,18 @@ out VS_OUT {
 uniform mat4 projection; // Projection matrix
 uniform mat4 view;       // View matrix
 uniform mat4 model;      // Model matrix
+uniform bool instanced;  // Take the model matrix from aInstanceModel instead
 
 void main()
 {
+    mat4 M = instanced ? aInstanceModel : model;
+
     // Transform vertex position to world space
-    vec4 fragPosWorld = model * vec4(aPos, 1.0);
+    vec4 fragPosWorld = M * vec4(aPos, 1.0);
     vs_out.FragPos = vec3(fragPosWorld);
 
     // Transform normal to world space and normalize
-    vs_out.Normal = mat3(transpose(inverse(model))) * aNormal;
+    vs_out.Normal = mat3(transpose(inverse(M))) * aNormal;
 
     // Pass texture coordinates unchanged
     vs_out.TexCoords = aTexCoords;
@@ -0,0 +1,15 @@
+#version 410 core
+
+out vec4 FragColor;
+
+in vec4 Color;
+
+void main()
+{
+    // round sprite, soft towards the edge
+    vec2 offset = gl_PointCoord * 2.0 - 1.0;
+    float distanceSquared = dot(offset, offset);
+    if (distanceSquared > 1.0)
+        discard;
+    FragColor = vec4(Color.rgb, Color.a * (1.0 - distanceSquared));
+}
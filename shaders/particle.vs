@@ -0,0 +1,27 @@
+#version 410 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in float aAge;
+layout(location = 3) in float aLifetime;
+layout(location = 4) in uint aColor;
+layout(location = 5) in float aSize;
+
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float viewportHeight; // in pixels, to turn the world-space size into a point size
+
+void main()
+{
+    float life = aAge / aLifetime;
+    vec4 viewPos = view * vec4(aPosition, 1.0);
+    gl_Position = projection * viewPos;
+    gl_PointSize = aSize * projection[1][1] * 0.5 * viewportHeight / max(-viewPos.z, 0.1);
+
+    // fade out over the lifetime; dead particles are moved outside the clip volume
+    Color = unpackUnorm4x8(aColor);
+    Color.a *= 1.0 - life;
+    if (life >= 1.0)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 410 core
+
+// Advances one particle per vertex; the outputs are captured with transform
+// feedback into the other buffer of the pair (rasterization is off)
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in float aAge;
+layout(location = 2) in vec3 aVelocity;
+layout(location = 3) in float aLifetime;
+layout(location = 4) in uint aColor;
+layout(location = 5) in float aSize;
+
+out vec3 Position;
+out float Age;
+out vec3 Velocity;
+out float Lifetime;
+flat out uint Color;
+out float Size;
+
+uniform float deltaTime;
+uniform float damping; // velocity factor for this step (drag)
+
+void main()
+{
+    Velocity = aVelocity * damping;
+    Position = aPosition + Velocity * deltaTime;
+    Age = aAge + deltaTime;
+    Lifetime = aLifetime;
+    Color = aColor;
+    Size = aSize;
+}
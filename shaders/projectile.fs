@@ -5,9 +5,9 @@ out vec4 FragColor;
 in vec2 TexCoords;
 in vec3 FragPos;
 in vec3 Normal;
+flat in vec3 MaterialColor;  // Main color (red in this case)
+flat in vec3 EmissionColor;  // Glow effect
 
-uniform vec3 materialColor;  // Main color (red in this case)
-uniform vec3 emissionColor;  // Glow effect
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
@@ -15,13 +15,13 @@ void main()
 {
     // Ambient lighting
     float ambientStrength = 0.2;
-    vec3 ambient = ambientStrength * materialColor;
+    vec3 ambient = ambientStrength * MaterialColor;
 
     // Diffuse lighting
     vec3 norm = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * materialColor;
+    vec3 diffuse = diff * MaterialColor;
 
     // Specular lighting
     float specularStrength = 0.5;
@@ -31,7 +31,7 @@ void main()
     vec3 specular = specularStrength * spec * vec3(1.0); // White specular highlights
 
     // Glow effect
-    vec3 glow = emissionColor;
+    vec3 glow = EmissionColor;
 
     // Combine lighting components
     vec3 result = ambient + diffuse + specular + glow;
@@ -3,19 +3,32 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoords;
+// per-instance data (indirect submission)
+layout(location = 3) in mat4 aInstanceModel;
+layout(location = 7) in vec3 aInstanceMaterialColor;
+layout(location = 8) in vec3 aInstanceEmissionColor;
 
 out vec2 TexCoords;
 out vec3 FragPos;
 out vec3 Normal;
+flat out vec3 MaterialColor;
+flat out vec3 EmissionColor;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 materialColor;  // Main color (red in this case)
+uniform vec3 emissionColor;  // Glow effect
+uniform bool instanced;      // Take model and colors from the instance attributes instead
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    mat4 M = instanced ? aInstanceModel : model;
+    MaterialColor = instanced ? aInstanceMaterialColor : materialColor;
+    EmissionColor = instanced ? aInstanceEmissionColor : emissionColor;
+
+    FragPos = vec3(M * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(M))) * aNormal;
     TexCoords = aTexCoords;
 
     gl_Position = projection * view * vec4(FragPos, 1.0);
@@ -0,0 +1,64 @@
+#include "Audio.h"
+
+#include <iostream>
+#include <SFML/Audio.hpp>
+
+sf::Music themeMusic;
+sf::SoundBuffer shootBuffer;
+sf::Sound shootSound(shootBuffer);
+
+sf::SoundBuffer explosionBuffer;
+sf::Sound explosionSound(explosionBuffer);
+
+// Function to initialize audio
+bool initializeAudio()
+{
+    // Load and play theme music
+    if (!themeMusic.openFromFile("resources/theme.ogg"))
+    {
+        std::cerr << "Error: Unable to load theme music.\n";
+        return false;
+    }
+
+    themeMusic.setVolume(50.0f);
+    themeMusic.setLooping(true);
+    themeMusic.play();
+
+    // Load shooting sound buffer
+    if (!shootBuffer.loadFromFile("resources/shoot.wav"))
+    {
+        std::cerr << "Error: Unable to load shooting sound effect.\n";
+        return false;
+    }
+
+    // Initialize shootSound with shootBuffer
+    shootSound.setBuffer(shootBuffer); // Assign the buffer to the sound
+    shootSound.setVolume(5.0f);        // Set desired volume
+
+    if (!explosionBuffer.loadFromFile("resources/explosion.wav"))
+    {
+        std::cerr << "Error: Unable to load explosion sound effect.\n";
+        return false;
+    }
+    explosionSound.setBuffer(explosionBuffer);
+    explosionSound.setVolume(5.0f); // Adjust volume as needed
+
+    std::cout << "Audio initialized successfully.\n";
+    return true;
+}
+
+void cleanupAudio()
+{
+    themeMusic.stop(); // Explicitly stop the music when exiting
+    // No explicit cleanup needed for `sf::Sound` or `sf::SoundBuffer` as SFML handles it internally
+}
+
+void playShootSound()
+{
+    shootSound.play();
+}
+
+void playExplosionSound()
+{
+    explosionSound.play();
+}
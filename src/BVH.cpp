@@ -0,0 +1,497 @@
+#include "BVH.h"
+#include "Model.h"
+
+#include <algorithm>
+
+// SAH costs relative to testing one triangle
+static const float TRAVERSAL_COST = 1.0f;
+static const int SAH_BINS = 12;
+static const uint32_t MAX_LEAF_TRIANGLES = 8;
+
+// Deeper ranges become leaves whatever their size, so the query stacks cannot overflow
+static const int MAX_DEPTH = 62;
+static const int STACK_SIZE = MAX_DEPTH + 2;
+
+// Subtrees become jobs once they are below this many triangles
+static const uint32_t MIN_TASK_TRIANGLES = 4096;
+
+// Marks a node in the top of the tree that stands for a subtree built by a task
+static const uint32_t TASK_NODE = UINT32_MAX;
+
+static float surfaceArea(const glm::vec3 &min, const glm::vec3 &max)
+{
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// One triangle while building: its box and its index as added. The array of these
+// is partitioned in place as the tree is split, so every pass over a node reads
+// one contiguous run.
+struct BuildPrimitive
+{
+    glm::vec3 min;
+    uint32_t triangle;
+    glm::vec3 max;
+    float padding;
+
+    glm::vec3 centroid() const { return (min + max) * 0.5f; }
+};
+
+struct BuildInput
+{
+    vector<BuildPrimitive> primitives;
+};
+
+struct BuildRange
+{
+    uint32_t begin, end;
+    int depth;
+};
+
+// Bounds of triangles [begin, end) and of their centroids
+static void rangeBounds(const BuildInput &in, uint32_t begin, uint32_t end, glm::vec3 &min, glm::vec3 &max, glm::vec3 &centroidMin, glm::vec3 &centroidMax)
+{
+    min = centroidMin = glm::vec3(std::numeric_limits<float>::max());
+    max = centroidMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (uint32_t i = begin; i < end; i++)
+    {
+        const BuildPrimitive &primitive = in.primitives[i];
+        min = glm::min(min, primitive.min);
+        max = glm::max(max, primitive.max);
+        glm::vec3 centroid = primitive.centroid();
+        centroidMin = glm::min(centroidMin, centroid);
+        centroidMax = glm::max(centroidMax, centroid);
+    }
+}
+
+struct SahBin
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+    uint32_t count = 0;
+};
+
+// Split [begin, end) by the binned SAH; returns false when a leaf is cheaper.
+// On success the primitives are partitioned and mid is the first one of the right half.
+static bool splitRange(BuildInput &in, uint32_t begin, uint32_t end, const glm::vec3 &min, const glm::vec3 &max,
+                       const glm::vec3 &centroidMin, const glm::vec3 &centroidMax, uint32_t &mid)
+{
+    uint32_t count = end - begin;
+    if (count <= 2)
+        return false;
+
+    // bin the centroids along all three axes in one pass
+    glm::vec3 extent = centroidMax - centroidMin;
+    glm::vec3 scale;
+    for (int axis = 0; axis < 3; axis++)
+        scale[axis] = extent[axis] > 0.0f ? SAH_BINS / extent[axis] : 0.0f;
+    SahBin bins[3][SAH_BINS];
+    for (uint32_t i = begin; i < end; i++)
+    {
+        const BuildPrimitive &primitive = in.primitives[i];
+        glm::vec3 offset = (primitive.centroid() - centroidMin) * scale;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            SahBin &bin = bins[axis][std::min(SAH_BINS - 1, static_cast<int>(offset[axis]))];
+            bin.count++;
+            bin.min = glm::min(bin.min, primitive.min);
+            bin.max = glm::max(bin.max, primitive.max);
+        }
+    }
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1, bestBin = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (extent[axis] <= 0.0f)
+            continue;
+
+        // sweep from the right to get the cost of every right half, then from the left
+        float rightArea[SAH_BINS];
+        uint32_t rightCount[SAH_BINS];
+        SahBin acc;
+        for (int b = SAH_BINS - 1; b > 0; b--)
+        {
+            acc.min = glm::min(acc.min, bins[axis][b].min);
+            acc.max = glm::max(acc.max, bins[axis][b].max);
+            acc.count += bins[axis][b].count;
+            rightArea[b] = acc.count ? surfaceArea(acc.min, acc.max) : 0.0f;
+            rightCount[b] = acc.count;
+        }
+        acc = SahBin();
+        for (int b = 0; b < SAH_BINS - 1; b++)
+        {
+            acc.min = glm::min(acc.min, bins[axis][b].min);
+            acc.max = glm::max(acc.max, bins[axis][b].max);
+            acc.count += bins[axis][b].count;
+            if (acc.count == 0 || rightCount[b + 1] == 0)
+                continue;
+            float cost = surfaceArea(acc.min, acc.max) * acc.count + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    float leafCost = static_cast<float>(count);
+    float parentArea = surfaceArea(min, max);
+    bool splitCheaper = bestAxis >= 0 && (parentArea <= 0.0f || TRAVERSAL_COST + bestCost / parentArea < leafCost);
+    if (!splitCheaper && count <= MAX_LEAF_TRIANGLES)
+        return false;
+
+    if (bestAxis < 0)
+    {
+        // every centroid in the same place: split the list in half so leaves stay small
+        mid = begin + count / 2;
+        return true;
+    }
+
+    float axisScale = scale[bestAxis], origin = centroidMin[bestAxis];
+    auto first = in.primitives.begin() + begin, last = in.primitives.begin() + end;
+    auto split = std::partition(first, last, [&](const BuildPrimitive &primitive)
+                                { return std::min(SAH_BINS - 1, static_cast<int>((primitive.centroid()[bestAxis] - origin) * axisScale)) <= bestBin; });
+    mid = static_cast<uint32_t>(split - in.primitives.begin());
+    return true;
+}
+
+// Build [begin, end) depth first into nodes; inner node offsets are indices into nodes
+static void buildSubtree(BuildInput &in, uint32_t begin, uint32_t end, int depth, vector<BVHNode> &nodes)
+{
+    glm::vec3 min, max, centroidMin, centroidMax;
+    rangeBounds(in, begin, end, min, max, centroidMin, centroidMax);
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(BVHNode{min, begin, max, end - begin});
+
+    uint32_t mid;
+    if (depth >= MAX_DEPTH || !splitRange(in, begin, end, min, max, centroidMin, centroidMax, mid))
+        return;
+
+    nodes[index].count = 0;
+    buildSubtree(in, begin, mid, depth + 1, nodes);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    buildSubtree(in, mid, end, depth + 1, nodes);
+}
+
+// Split the top of the tree on this thread, down to ranges of at most taskSize
+// triangles; those become TASK_NODE placeholders (offset = task index)
+static void buildTop(BuildInput &in, uint32_t begin, uint32_t end, int depth, uint32_t taskSize, vector<BVHNode> &nodes, vector<BuildRange> &tasks)
+{
+    glm::vec3 min, max, centroidMin, centroidMax;
+    rangeBounds(in, begin, end, min, max, centroidMin, centroidMax);
+
+    if (end - begin <= taskSize)
+    {
+        nodes.push_back(BVHNode{min, static_cast<uint32_t>(tasks.size()), max, TASK_NODE});
+        tasks.push_back(BuildRange{begin, end, depth});
+        return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(BVHNode{min, begin, max, end - begin});
+
+    uint32_t mid;
+    if (depth >= MAX_DEPTH || !splitRange(in, begin, end, min, max, centroidMin, centroidMax, mid))
+        return;
+
+    nodes[index].count = 0;
+    buildTop(in, begin, mid, depth + 1, taskSize, nodes, tasks);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    buildTop(in, mid, end, depth + 1, taskSize, nodes, tasks);
+}
+
+void TriangleBVH::addTriangles(const vector<Vertex> &vertices, const vector<unsigned int> &indices, const glm::mat4 &transform)
+{
+    input.reserve(input.size() + indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        input.push_back(BVHTriangle{glm::vec3(transform * glm::vec4(vertices[indices[i]].Position, 1.0f)),
+                                    glm::vec3(transform * glm::vec4(vertices[indices[i + 1]].Position, 1.0f)),
+                                    glm::vec3(transform * glm::vec4(vertices[indices[i + 2]].Position, 1.0f))});
+    }
+}
+
+void TriangleBVH::addMesh(const Mesh &mesh, const glm::mat4 &transform)
+{
+    addTriangles(mesh.vertices, mesh.indices, transform);
+}
+
+void TriangleBVH::addModel(const Model &model, const glm::mat4 &transform)
+{
+    for (const Mesh &mesh : model.getMeshes())
+        addMesh(mesh, transform);
+}
+
+void TriangleBVH::clear()
+{
+    input.clear();
+    nodes.clear();
+    triangles.clear();
+    triangleIds.clear();
+}
+
+void TriangleBVH::build(JobSystem *jobs)
+{
+    // triangles added after an earlier build are built together with the old ones
+    if (!triangles.empty())
+    {
+        vector<BVHTriangle> all(triangles.size());
+        for (size_t i = 0; i < triangles.size(); i++)
+            all[triangleIds[i]] = triangles[i];
+        all.insert(all.end(), input.begin(), input.end());
+        input.swap(all);
+    }
+    nodes.clear();
+    triangles.clear();
+    triangleIds.clear();
+    if (input.empty())
+        return;
+
+    uint32_t count = static_cast<uint32_t>(input.size());
+    BuildInput in;
+    in.primitives.resize(count);
+    for (uint32_t t = 0; t < count; t++)
+    {
+        const BVHTriangle &tri = input[t];
+        in.primitives[t] = BuildPrimitive{glm::min(tri.a, glm::min(tri.b, tri.c)), t, glm::max(tri.a, glm::max(tri.b, tri.c)), 0.0f};
+    }
+
+    // about four tasks per thread, so uneven subtrees still keep every thread busy
+    unsigned int threads = jobs ? jobs->workerCount() + 1 : 1;
+    uint32_t taskSize = threads > 1 ? std::max(MIN_TASK_TRIANGLES, count / (threads * 4)) : count;
+    vector<BVHNode> top;
+    vector<BuildRange> tasks;
+    buildTop(in, 0, count, 0, taskSize, top, tasks);
+
+    // every task owns a disjoint range of primitives, so they can be built concurrently
+    vector<vector<BVHNode>> subtrees(tasks.size());
+    auto buildTasks = [&](size_t first, size_t last)
+    {
+        for (size_t task = first; task < last; task++)
+            buildSubtree(in, tasks[task].begin, tasks[task].end, tasks[task].depth, subtrees[task]);
+    };
+    if (jobs)
+        jobs->parallelFor(tasks.size(), 1, buildTasks);
+    else
+        buildTasks(0, tasks.size());
+
+    // stitch: copy the top nodes in order, splicing each task's subtree in place of its
+    // placeholder, then point the top inner nodes at their right children's new indices
+    size_t total = top.size() - tasks.size();
+    for (const auto &subtree : subtrees)
+        total += subtree.size();
+    nodes.reserve(total);
+    vector<uint32_t> topIndex(top.size());
+    for (size_t i = 0; i < top.size(); i++)
+    {
+        uint32_t base = static_cast<uint32_t>(nodes.size());
+        topIndex[i] = base;
+        if (top[i].count != TASK_NODE)
+        {
+            nodes.push_back(top[i]);
+            continue;
+        }
+        for (BVHNode node : subtrees[top[i].offset])
+        {
+            if (!node.isLeaf())
+                node.offset += base;
+            nodes.push_back(node);
+        }
+    }
+    for (size_t i = 0; i < top.size(); i++)
+    {
+        if (top[i].count == 0)
+            nodes[topIndex[i]].offset = topIndex[top[i].offset];
+    }
+
+    // triangles in leaf order, so a leaf reads one contiguous run
+    triangles.resize(count);
+    triangleIds.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        triangleIds[i] = in.primitives[i].triangle;
+        triangles[i] = input[triangleIds[i]];
+    }
+    input.clear();
+    input.shrink_to_fit();
+}
+
+BoundingBox TriangleBVH::bounds() const
+{
+    BoundingBox box;
+    if (!nodes.empty())
+    {
+        box.min = nodes[0].min;
+        box.max = nodes[0].max;
+    }
+    return box;
+}
+
+// Entry distance of the ray into the node's box, or infinity when it misses within maxDistance
+static inline float rayBoxEntry(const BVHNode &node, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float maxDistance)
+{
+    glm::vec3 t1 = (node.min - origin) * inverseDirection;
+    glm::vec3 t2 = (node.max - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+// Moller-Trumbore; returns the distance or a negative value on a miss
+static inline float rayTriangle(const BVHTriangle &tri, const glm::vec3 &origin, const glm::vec3 &direction)
+{
+    glm::vec3 e1 = tri.b - tri.a, e2 = tri.c - tri.a;
+    glm::vec3 p = glm::cross(direction, e2);
+    float det = glm::dot(e1, p);
+    if (std::abs(det) < 1e-12f)
+        return -1.0f;
+    float inverseDet = 1.0f / det;
+    glm::vec3 s = origin - tri.a;
+    float u = glm::dot(s, p) * inverseDet;
+    if (u < 0.0f || u > 1.0f)
+        return -1.0f;
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(direction, q) * inverseDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return -1.0f;
+    return glm::dot(e2, q) * inverseDet;
+}
+
+bool TriangleBVH::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, RayHit &hit) const
+{
+    if (nodes.empty())
+        return false;
+
+    // division by a zero component gives infinity, which the slab test handles
+    glm::vec3 inverseDirection = 1.0f / direction;
+    float nearest = maxDistance;
+    uint32_t nearestTriangle = UINT32_MAX;
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    if (rayBoxEntry(nodes[0], origin, inverseDirection, nearest) == std::numeric_limits<float>::infinity())
+        return false;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const BVHNode &node = nodes[stack[--top]];
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+            {
+                float t = rayTriangle(triangles[i], origin, direction);
+                if (t >= 0.0f && t <= nearest)
+                {
+                    nearest = t;
+                    nearestTriangle = i;
+                }
+            }
+            continue;
+        }
+
+        // visit the nearer child first, so the far one is often culled by the hit found
+        uint32_t left = static_cast<uint32_t>(&node - nodes.data()) + 1, right = node.offset;
+        float leftEntry = rayBoxEntry(nodes[left], origin, inverseDirection, nearest);
+        float rightEntry = rayBoxEntry(nodes[right], origin, inverseDirection, nearest);
+        if (leftEntry > rightEntry)
+        {
+            std::swap(left, right);
+            std::swap(leftEntry, rightEntry);
+        }
+        if (rightEntry != std::numeric_limits<float>::infinity())
+            stack[top++] = right;
+        if (leftEntry != std::numeric_limits<float>::infinity())
+            stack[top++] = left;
+    }
+
+    if (nearestTriangle == UINT32_MAX)
+        return false;
+    const BVHTriangle &tri = triangles[nearestTriangle];
+    hit.distance = nearest;
+    hit.triangle = triangleIds[nearestTriangle];
+    hit.normal = glm::normalize(glm::cross(tri.b - tri.a, tri.c - tri.a));
+    return true;
+}
+
+// Project the triangle and the box half extents onto axis and test for a gap
+static inline bool separated(const glm::vec3 &axis, const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2, const glm::vec3 &halfExtents)
+{
+    float p0 = glm::dot(axis, v0), p1 = glm::dot(axis, v1), p2 = glm::dot(axis, v2);
+    float radius = halfExtents.x * std::abs(axis.x) + halfExtents.y * std::abs(axis.y) + halfExtents.z * std::abs(axis.z);
+    return std::max(p0, std::max(p1, p2)) < -radius || std::min(p0, std::min(p1, p2)) > radius;
+}
+
+bool triangleOverlapsBox(const BVHTriangle &triangle, const glm::vec3 &min, const glm::vec3 &max)
+{
+    // Akenine-Moller: the box axes, the triangle normal and the 9 edge cross products
+    glm::vec3 center = (min + max) * 0.5f, halfExtents = (max - min) * 0.5f;
+    glm::vec3 v0 = triangle.a - center, v1 = triangle.b - center, v2 = triangle.c - center;
+
+    if (std::max(v0.x, std::max(v1.x, v2.x)) < -halfExtents.x || std::min(v0.x, std::min(v1.x, v2.x)) > halfExtents.x ||
+        std::max(v0.y, std::max(v1.y, v2.y)) < -halfExtents.y || std::min(v0.y, std::min(v1.y, v2.y)) > halfExtents.y ||
+        std::max(v0.z, std::max(v1.z, v2.z)) < -halfExtents.z || std::min(v0.z, std::min(v1.z, v2.z)) > halfExtents.z)
+        return false;
+
+    glm::vec3 edges[3] = {v1 - v0, v2 - v1, v0 - v2};
+    if (separated(glm::cross(edges[0], edges[1]), v0, v1, v2, halfExtents))
+        return false;
+
+    const glm::vec3 boxAxes[3] = {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+    for (const glm::vec3 &edge : edges)
+        for (const glm::vec3 &boxAxis : boxAxes)
+            if (separated(glm::cross(boxAxis, edge), v0, v1, v2, halfExtents))
+                return false;
+    return true;
+}
+
+// Call visit(i) for every triangle (leaf order) intersecting the box until it returns true
+template <typename Visit>
+bool TriangleBVH::visitBox(const glm::vec3 &min, const glm::vec3 &max, Visit visit) const
+{
+    if (nodes.empty())
+        return false;
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint32_t index = stack[--top];
+        const BVHNode &node = nodes[index];
+        if (node.min.x > max.x || node.max.x < min.x || node.min.y > max.y || node.max.y < min.y || node.min.z > max.z || node.max.z < min.z)
+            continue;
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+            {
+                if (triangleOverlapsBox(triangles[i], min, max) && visit(i))
+                    return true;
+            }
+            continue;
+        }
+        stack[top++] = node.offset;
+        stack[top++] = index + 1;
+    }
+    return false;
+}
+
+bool TriangleBVH::overlaps(const glm::vec3 &min, const glm::vec3 &max) const
+{
+    return visitBox(min, max, [](uint32_t)
+                    { return true; });
+}
+
+size_t TriangleBVH::queryBox(const glm::vec3 &min, const glm::vec3 &max, vector<uint32_t> &found) const
+{
+    size_t before = found.size();
+    visitBox(min, max, [&](uint32_t i)
+             {
+        found.push_back(triangleIds[i]);
+        return false; });
+    std::sort(found.begin() + before, found.end());
+    return found.size() - before;
+}
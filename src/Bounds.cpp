@@ -0,0 +1,36 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+BoundingBox transformBox(const BoundingBox &box, const glm::mat4 &M)
+{
+    if (box.empty())
+        return box;
+
+    // start from the translation and add the smaller/larger product of each matrix entry per axis
+    BoundingBox result;
+    result.min = result.max = glm::vec3(M[3]);
+    for (int column = 0; column < 3; column++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            float a = M[column][row] * box.min[column];
+            float b = M[column][row] * box.max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+BoundingSphere transformSphere(const BoundingSphere &sphere, const glm::mat4 &M)
+{
+    BoundingSphere result;
+    result.center = glm::vec3(M * glm::vec4(sphere.center, 1.0f));
+    float scale2 = std::max({glm::dot(glm::vec3(M[0]), glm::vec3(M[0])),
+                             glm::dot(glm::vec3(M[1]), glm::vec3(M[1])),
+                             glm::dot(glm::vec3(M[2]), glm::vec3(M[2]))});
+    result.radius = sphere.radius * std::sqrt(scale2);
+    return result;
+}
@@ -0,0 +1,231 @@
+#include "Collision.h"
+
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define COLLISION_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLLISION_SSE 1
+#endif
+
+void BoxSet::clear()
+{
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+}
+
+void BoxSet::add(const glm::vec3 &min, const glm::vec3 &max)
+{
+    minX.push_back(min.x);
+    minY.push_back(min.y);
+    minZ.push_back(min.z);
+    maxX.push_back(max.x);
+    maxY.push_back(max.y);
+    maxZ.push_back(max.z);
+}
+
+void BoxSet::remove(size_t index)
+{
+    minX.erase(minX.begin() + index);
+    minY.erase(minY.begin() + index);
+    minZ.erase(minZ.begin() + index);
+    maxX.erase(maxX.begin() + index);
+    maxY.erase(maxY.begin() + index);
+    maxZ.erase(maxZ.begin() + index);
+}
+
+#if defined(COLLISION_AVX)
+// Bits for the 8 boxes from i
+static inline uint32_t overlap8(const __m256 a[6], const BoxSet &boxes, size_t i)
+{
+    __m256 x = _mm256_and_ps(_mm256_cmp_ps(a[0], _mm256_loadu_ps(&boxes.maxX[i]), _CMP_LE_OQ),
+                             _mm256_cmp_ps(a[3], _mm256_loadu_ps(&boxes.minX[i]), _CMP_GE_OQ));
+    __m256 y = _mm256_and_ps(_mm256_cmp_ps(a[1], _mm256_loadu_ps(&boxes.maxY[i]), _CMP_LE_OQ),
+                             _mm256_cmp_ps(a[4], _mm256_loadu_ps(&boxes.minY[i]), _CMP_GE_OQ));
+    __m256 z = _mm256_and_ps(_mm256_cmp_ps(a[2], _mm256_loadu_ps(&boxes.maxZ[i]), _CMP_LE_OQ),
+                             _mm256_cmp_ps(a[5], _mm256_loadu_ps(&boxes.minZ[i]), _CMP_GE_OQ));
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(x, _mm256_and_ps(y, z))));
+}
+#elif defined(COLLISION_SSE)
+// Bits for the 4 boxes from i
+static inline uint32_t overlap4(const __m128 a[6], const BoxSet &boxes, size_t i)
+{
+    __m128 x = _mm_and_ps(_mm_cmple_ps(a[0], _mm_loadu_ps(&boxes.maxX[i])), _mm_cmpge_ps(a[3], _mm_loadu_ps(&boxes.minX[i])));
+    __m128 y = _mm_and_ps(_mm_cmple_ps(a[1], _mm_loadu_ps(&boxes.maxY[i])), _mm_cmpge_ps(a[4], _mm_loadu_ps(&boxes.minY[i])));
+    __m128 z = _mm_and_ps(_mm_cmple_ps(a[2], _mm_loadu_ps(&boxes.maxZ[i])), _mm_cmpge_ps(a[5], _mm_loadu_ps(&boxes.minZ[i])));
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(x, _mm_and_ps(y, z))));
+}
+#endif
+
+uint32_t overlapMask(const glm::vec3 &min, const glm::vec3 &max, const BoxSet &boxes, size_t first)
+{
+    size_t end = std::min(first + OVERLAP_BATCH, boxes.size());
+    uint32_t mask = 0;
+
+    size_t i = first;
+#if defined(COLLISION_AVX)
+    const __m256 a[6] = {_mm256_set1_ps(min.x), _mm256_set1_ps(min.y), _mm256_set1_ps(min.z),
+                         _mm256_set1_ps(max.x), _mm256_set1_ps(max.y), _mm256_set1_ps(max.z)};
+    if (end - first == OVERLAP_BATCH)
+        return overlap8(a, boxes, first) | overlap8(a, boxes, first + 8) << 8;
+    for (; i + 8 <= end; i += 8)
+        mask |= overlap8(a, boxes, i) << (i - first);
+#elif defined(COLLISION_SSE)
+    const __m128 a[6] = {_mm_set1_ps(min.x), _mm_set1_ps(min.y), _mm_set1_ps(min.z),
+                         _mm_set1_ps(max.x), _mm_set1_ps(max.y), _mm_set1_ps(max.z)};
+    if (end - first == OVERLAP_BATCH)
+        return overlap4(a, boxes, first) | overlap4(a, boxes, first + 4) << 4 |
+               overlap4(a, boxes, first + 8) << 8 | overlap4(a, boxes, first + 12) << 12;
+    for (; i + 4 <= end; i += 4)
+        mask |= overlap4(a, boxes, i) << (i - first);
+#endif
+    for (; i < end; i++)
+    {
+        if (checkCollision(min, max, glm::vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), glm::vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])))
+            mask |= 1u << (i - first);
+    }
+    return mask;
+}
+
+void SweptBoxSet::clear()
+{
+    start.clear();
+    inverseDx.clear();
+    inverseDy.clear();
+    inverseDz.clear();
+}
+
+// 1 / d, infinite when d is 0
+static inline float inverse(float d)
+{
+    return d != 0.0f ? 1.0f / d : std::numeric_limits<float>::infinity();
+}
+
+void SweptBoxSet::add(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &displacement)
+{
+    start.add(min, max);
+    inverseDx.push_back(inverse(displacement.x));
+    inverseDy.push_back(inverse(displacement.y));
+    inverseDz.push_back(inverse(displacement.z));
+}
+
+void SweptBoxSet::remove(size_t index)
+{
+    start.remove(index);
+    inverseDx.erase(inverseDx.begin() + index);
+    inverseDy.erase(inverseDy.begin() + index);
+    inverseDz.erase(inverseDz.begin() + index);
+}
+
+// min and max as minps / maxps compute them: the second operand when either is NaN
+static inline float minLane(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+static inline float maxLane(float a, float b)
+{
+    return a > b ? a : b;
+}
+
+// Narrow [enter, exit] (fractions of the move) to when a moving interval [minA, maxA] + t * d
+// overlaps [minB, maxB], given inverseD = 1 / d.
+//
+// On a still axis inverseD is infinite, so both times are -inf/+inf when the intervals overlap
+// and both +inf or both -inf when they never will. Touching gives 0 * inf = NaN, which the
+// operand order below turns into "no limit", so touching still counts. The SIMD versions do
+// exactly the same operations, lane by lane.
+static inline void sweepAxis(float minA, float maxA, float inverseD, float minB, float maxB, float &enter, float &exit)
+{
+    float t1 = (minB - maxA) * inverseD;
+    float t2 = (maxB - minA) * inverseD;
+    enter = maxLane(minLane(t2, t1), enter);
+    exit = minLane(maxLane(t1, t2), exit);
+}
+
+bool checkSweptCollision(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &displacement,
+                         const glm::vec3 &minB, const glm::vec3 &maxB)
+{
+    float enter = 0.0f, exit = 1.0f;
+    sweepAxis(minA.x, maxA.x, inverse(displacement.x), minB.x, maxB.x, enter, exit);
+    sweepAxis(minA.y, maxA.y, inverse(displacement.y), minB.y, maxB.y, enter, exit);
+    sweepAxis(minA.z, maxA.z, inverse(displacement.z), minB.z, maxB.z, enter, exit);
+    return enter <= exit;
+}
+
+#if defined(COLLISION_AVX)
+static inline void sweepAxis8(__m256 minB, __m256 maxB, const float *minA, const float *maxA, const float *inverseD,
+                              __m256 &enter, __m256 &exit)
+{
+    __m256 scale = _mm256_loadu_ps(inverseD);
+    __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(minB, _mm256_loadu_ps(maxA)), scale);
+    __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(maxB, _mm256_loadu_ps(minA)), scale);
+    enter = _mm256_max_ps(_mm256_min_ps(t2, t1), enter);
+    exit = _mm256_min_ps(_mm256_max_ps(t1, t2), exit);
+}
+
+// Bits for the 8 moving boxes from i
+static inline uint32_t sweptOverlap8(const __m256 b[6], const SweptBoxSet &boxes, size_t i)
+{
+    __m256 enter = _mm256_setzero_ps(), exit = _mm256_set1_ps(1.0f);
+    sweepAxis8(b[0], b[3], &boxes.start.minX[i], &boxes.start.maxX[i], &boxes.inverseDx[i], enter, exit);
+    sweepAxis8(b[1], b[4], &boxes.start.minY[i], &boxes.start.maxY[i], &boxes.inverseDy[i], enter, exit);
+    sweepAxis8(b[2], b[5], &boxes.start.minZ[i], &boxes.start.maxZ[i], &boxes.inverseDz[i], enter, exit);
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(enter, exit, _CMP_LE_OQ)));
+}
+#elif defined(COLLISION_SSE)
+static inline void sweepAxis4(__m128 minB, __m128 maxB, const float *minA, const float *maxA, const float *inverseD,
+                              __m128 &enter, __m128 &exit)
+{
+    __m128 scale = _mm_loadu_ps(inverseD);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(minB, _mm_loadu_ps(maxA)), scale);
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(maxB, _mm_loadu_ps(minA)), scale);
+    enter = _mm_max_ps(_mm_min_ps(t2, t1), enter);
+    exit = _mm_min_ps(_mm_max_ps(t1, t2), exit);
+}
+
+// Bits for the 4 moving boxes from i
+static inline uint32_t sweptOverlap4(const __m128 b[6], const SweptBoxSet &boxes, size_t i)
+{
+    __m128 enter = _mm_setzero_ps(), exit = _mm_set1_ps(1.0f);
+    sweepAxis4(b[0], b[3], &boxes.start.minX[i], &boxes.start.maxX[i], &boxes.inverseDx[i], enter, exit);
+    sweepAxis4(b[1], b[4], &boxes.start.minY[i], &boxes.start.maxY[i], &boxes.inverseDy[i], enter, exit);
+    sweepAxis4(b[2], b[5], &boxes.start.minZ[i], &boxes.start.maxZ[i], &boxes.inverseDz[i], enter, exit);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(enter, exit)));
+}
+#endif
+
+uint32_t sweptOverlapMask(const glm::vec3 &min, const glm::vec3 &max, const SweptBoxSet &boxes, size_t first)
+{
+    size_t end = std::min(first + OVERLAP_BATCH, boxes.size());
+    uint32_t mask = 0;
+
+    size_t i = first;
+#if defined(COLLISION_AVX)
+    const __m256 b[6] = {_mm256_set1_ps(min.x), _mm256_set1_ps(min.y), _mm256_set1_ps(min.z),
+                         _mm256_set1_ps(max.x), _mm256_set1_ps(max.y), _mm256_set1_ps(max.z)};
+    for (; i + 8 <= end; i += 8)
+        mask |= sweptOverlap8(b, boxes, i) << (i - first);
+#elif defined(COLLISION_SSE)
+    const __m128 b[6] = {_mm_set1_ps(min.x), _mm_set1_ps(min.y), _mm_set1_ps(min.z),
+                         _mm_set1_ps(max.x), _mm_set1_ps(max.y), _mm_set1_ps(max.z)};
+    for (; i + 4 <= end; i += 4)
+        mask |= sweptOverlap4(b, boxes, i) << (i - first);
+#endif
+    for (; i < end; i++)
+    {
+        float enter = 0.0f, exit = 1.0f;
+        sweepAxis(boxes.start.minX[i], boxes.start.maxX[i], boxes.inverseDx[i], min.x, max.x, enter, exit);
+        sweepAxis(boxes.start.minY[i], boxes.start.maxY[i], boxes.inverseDy[i], min.y, max.y, enter, exit);
+        sweepAxis(boxes.start.minZ[i], boxes.start.maxZ[i], boxes.inverseDz[i], min.z, max.z, enter, exit);
+        if (enter <= exit)
+            mask |= 1u << (i - first);
+    }
+    return mask;
+}
@@ -0,0 +1,65 @@
+#include "Formation.h"
+
+void Formation::reset(std::vector<glm::vec3> newSlots)
+{
+    slots = std::move(newSlots);
+    alive = slots.size();
+    aliveBits.assign((slots.size() + 63) / 64, ~uint64_t(0));
+    if (slots.size() % 64 != 0)
+        aliveBits.back() = (uint64_t(1) << (slots.size() % 64)) - 1;
+
+    offset = previousOffset = glm::vec3(0.0f);
+    minSlot = maxSlot = slots.empty() ? glm::vec3(0.0f) : slots[0];
+    for (const glm::vec3 &slot : slots)
+    {
+        minSlot = glm::min(minSlot, slot);
+        maxSlot = glm::max(maxSlot, slot);
+    }
+}
+
+void Formation::kill(size_t slot)
+{
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (aliveBits[slot / 64] & bit)
+    {
+        aliveBits[slot / 64] &= ~bit;
+        alive--;
+    }
+}
+
+size_t Formation::nthAlive(size_t n) const
+{
+    // skip whole words by their population count, then bits within the word
+    for (size_t word = 0; word < aliveBits.size(); word++)
+    {
+        uint64_t bits = aliveBits[word];
+        size_t count = static_cast<size_t>(__builtin_popcountll(bits));
+        if (n >= count)
+        {
+            n -= count;
+            continue;
+        }
+        for (; n > 0; n--)
+            bits &= bits - 1;
+        return word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+    }
+    return slots.size();
+}
+
+std::vector<glm::vec3> createFormationSlots(const glm::vec3 &center, int rows, int cols, float rowSpacing, float colSpacing)
+{
+    std::vector<glm::vec3> slots;
+
+    // Calculate the offset to center the grid around the center
+    float xOffset = -((cols - 1) * colSpacing) / 2.0f;
+    float zOffset = -((rows - 1) * rowSpacing) / 2.0f;
+
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int col = 0; col < cols; ++col)
+        {
+            slots.push_back(center + glm::vec3(xOffset + col * colSpacing, 0.0f, zOffset + row * rowSpacing));
+        }
+    }
+    return slots;
+}
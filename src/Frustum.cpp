@@ -0,0 +1,116 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+Frustum::Frustum(const glm::mat4 &m)
+{
+    // Gribb/Hartmann: each plane is the last row of the matrix plus or minus one of the others
+    // (glm is column major, so row i is m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 row0(m[0].x, m[1].x, m[2].x, m[3].x);
+    glm::vec4 row1(m[0].y, m[1].y, m[2].y, m[3].y);
+    glm::vec4 row2(m[0].z, m[1].z, m[2].z, m[3].z);
+    glm::vec4 row3(m[0].w, m[1].w, m[2].w, m[3].w);
+    const glm::vec4 planes[6] = {
+        row3 + row0, // left
+        row3 - row0, // right
+        row3 + row1, // bottom
+        row3 - row1, // top
+        row3 + row2, // near
+        row3 - row2, // far
+    };
+
+    for (int i = 0; i < 6; i++)
+    {
+        // normalize so the plane distance is in world units and comparable to a radius
+        float length = std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+        nx[i] = planes[i].x / length;
+        ny[i] = planes[i].y / length;
+        nz[i] = planes[i].z / length;
+        d[i] = planes[i].w / length;
+    }
+}
+
+void CullBatch::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+    visible.clear();
+    visibleTotal = 0;
+}
+
+size_t CullBatch::add(const BoundingSphere &sphere)
+{
+    x.push_back(sphere.center.x);
+    y.push_back(sphere.center.y);
+    z.push_back(sphere.center.z);
+    radius.push_back(sphere.radius);
+    return x.size() - 1;
+}
+
+size_t CullBatch::add(const BoundingSphere &sphere, const glm::vec3 *positions, size_t count)
+{
+    size_t first = x.size();
+    x.resize(first + count);
+    y.resize(first + count);
+    z.resize(first + count);
+    radius.resize(first + count, sphere.radius);
+    for (size_t i = 0; i < count; i++)
+    {
+        x[first + i] = positions[i].x + sphere.center.x;
+        y[first + i] = positions[i].y + sphere.center.y;
+        z[first + i] = positions[i].z + sphere.center.z;
+    }
+    return first;
+}
+
+void CullBatch::cull(const Frustum &frustum)
+{
+    size_t count = x.size();
+    visible.assign(count, 0);
+    visibleTotal = 0;
+
+    size_t i = 0;
+#ifdef FRUSTUM_SSE
+    // four spheres per iteration: a sphere is outside when it is fully behind any plane
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(&x[i]);
+        __m128 py = _mm_loadu_ps(&y[i]);
+        __m128 pz = _mm_loadu_ps(&z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(frustum.nx[p])),
+                                                    _mm_mul_ps(py, _mm_set1_ps(frustum.ny[p]))),
+                                         _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(frustum.nz[p])),
+                                                    _mm_set1_ps(frustum.d[p])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            visible[i + lane] = (mask >> lane) & 1;
+            visibleTotal += visible[i + lane];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6; p++)
+        {
+            float distance = frustum.nx[p] * x[i] + frustum.ny[p] * y[i] + frustum.nz[p] * z[i] + frustum.d[p];
+            inside = inside && distance >= -radius[i];
+        }
+        visible[i] = inside ? 1 : 0;
+        visibleTotal += visible[i];
+    }
+}
@@ -0,0 +1,30 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+GLExtensions glExtensions;
+
+static bool hasExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+    glExtensions = GLExtensions();
+
+    bool core43 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    if (core43 || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance")))
+    {
+        glExtensions.MultiDrawElementsIndirect = (MultiDrawElementsIndirectProc)load("glMultiDrawElementsIndirect");
+        glExtensions.multiDrawIndirect = glExtensions.MultiDrawElementsIndirect != nullptr;
+    }
+}
@@ -0,0 +1,170 @@
+#include "GLState.h"
+#include "GLExtensions.h"
+
+GLStateCache glState;
+
+bool GLStateCache::changed(unsigned int &cached, unsigned int value)
+{
+    if (cached == value)
+    {
+        frame.redundantSkipped++;
+        return false;
+    }
+    cached = value;
+    frame.stateChanges++;
+    return true;
+}
+
+void GLStateCache::useProgram(unsigned int id)
+{
+    if (changed(program, id))
+        glUseProgram(id);
+}
+
+void GLStateCache::bindVertexArray(unsigned int id)
+{
+    if (changed(vao, id))
+        glBindVertexArray(id);
+}
+
+void GLStateCache::bindTexture(unsigned int unit, GLenum target, unsigned int texture)
+{
+    if (unit >= MAX_TEXTURE_UNITS)
+    {
+        // outside the cache: always issue it
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        activeUnit = unit;
+        frame.stateChanges += 2;
+        return;
+    }
+
+    unsigned int &bound = target == GL_TEXTURE_CUBE_MAP ? texturesCube[unit] : textures2D[unit];
+    if (bound == texture)
+    {
+        frame.redundantSkipped++;
+        return;
+    }
+    if (changed(activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+    bound = texture;
+    frame.stateChanges++;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::setEnabled(GLenum capability, bool enabled)
+{
+    int index = -1;
+    switch (capability)
+    {
+    case GL_DEPTH_TEST:
+        index = 0;
+        break;
+    case GL_BLEND:
+        index = 1;
+        break;
+    case GL_CULL_FACE:
+        index = 2;
+        break;
+    }
+
+    if (index >= 0)
+    {
+        if (capabilities[index] == (enabled ? 1 : 0))
+        {
+            frame.redundantSkipped++;
+            return;
+        }
+        capabilities[index] = enabled ? 1 : 0;
+    }
+
+    frame.stateChanges++;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+    if (depth == func)
+    {
+        frame.redundantSkipped++;
+        return;
+    }
+    depth = func;
+    frame.stateChanges++;
+    glDepthFunc(func);
+}
+
+void GLStateCache::depthMask(bool write)
+{
+    if (depthWrite == (write ? 1 : 0))
+    {
+        frame.redundantSkipped++;
+        return;
+    }
+    depthWrite = write ? 1 : 0;
+    frame.stateChanges++;
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLStateCache::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+    if (blendSrc == sfactor && blendDst == dfactor)
+    {
+        frame.redundantSkipped++;
+        return;
+    }
+    blendSrc = sfactor;
+    blendDst = dfactor;
+    frame.stateChanges++;
+    glBlendFunc(sfactor, dfactor);
+}
+
+void GLStateCache::drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    frame.drawCalls++;
+    glDrawElements(mode, count, type, indices);
+}
+
+void GLStateCache::drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint baseVertex)
+{
+    frame.drawCalls++;
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+void GLStateCache::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    frame.drawCalls++;
+    glDrawArrays(mode, first, count);
+}
+
+void GLStateCache::multiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount)
+{
+    frame.drawCalls++;
+    glExtensions.MultiDrawElementsIndirect(mode, type, indirect, drawcount, 0);
+}
+
+void GLStateCache::endFrame()
+{
+    lastFrame = frame;
+    frame = RenderStats();
+}
+
+void GLStateCache::invalidate()
+{
+    program = UNKNOWN;
+    vao = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++)
+    {
+        textures2D[i] = UNKNOWN;
+        texturesCube[i] = UNKNOWN;
+    }
+    for (int &capability : capabilities)
+        capability = -1;
+    depth = 0;
+    depthWrite = -1;
+    blendSrc = blendDst = 0;
+}
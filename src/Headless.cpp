@@ -0,0 +1,326 @@
+#include "Headless.h"
+#include "GLExtensions.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+// keep eglplatform.h from pulling in Xlib (it defines None, Bool, Status...)
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+bool writePNG(const std::string &path, int width, int height, const std::vector<unsigned char> &pixels)
+{
+    static uint32_t crcTable[256];
+    static bool crcReady = false;
+    if (!crcReady)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crcTable[n] = c;
+        }
+        crcReady = true;
+    }
+
+    // raw scanlines, top row first, each prefixed by filter type 0
+    const size_t stride = static_cast<size_t>(width) * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = height - 1; y >= 0; y--)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * stride, pixels.begin() + (y + 1) * stride);
+    }
+
+    // zlib stream made of stored blocks (max 65535 bytes each)
+    std::vector<unsigned char> z = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < raw.size();)
+    {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        z.push_back(pos + len == raw.size() ? 1 : 0);
+        z.push_back(len & 0xFF);
+        z.push_back((len >> 8) & 0xFF);
+        z.push_back(~len & 0xFF);
+        z.push_back((~len >> 8) & 0xFF);
+        for (size_t i = 0; i < len; i++)
+        {
+            a = (a + raw[pos + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int i = 3; i >= 0; i--)
+        z.push_back((adler >> (i * 8)) & 0xFF);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Error: Unable to write capture: " << path << std::endl;
+        return false;
+    }
+
+    auto put32 = [&out](uint32_t v)
+    {
+        unsigned char be[4] = {(unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v};
+        out.write(reinterpret_cast<char *>(be), 4);
+    };
+    auto chunk = [&](const char *type, const unsigned char *data, size_t len)
+    {
+        put32(static_cast<uint32_t>(len));
+        uint32_t c = 0xFFFFFFFFu;
+        for (int i = 0; i < 4; i++)
+            c = crcTable[(c ^ static_cast<unsigned char>(type[i])) & 0xFF] ^ (c >> 8);
+        for (size_t i = 0; i < len; i++)
+            c = crcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        out.write(type, 4);
+        out.write(reinterpret_cast<const char *>(data), len);
+        put32(c ^ 0xFFFFFFFFu);
+    };
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char *>(signature), 8);
+    unsigned char ihdr[13] = {
+        (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+        (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+        8, 2, 0, 0, 0}; // 8-bit RGB, no interlace
+    chunk("IHDR", ihdr, sizeof(ihdr));
+    chunk("IDAT", z.data(), z.size());
+    chunk("IEND", nullptr, 0);
+    return static_cast<bool>(out);
+}
+
+bool scriptedKeyPressed(int key, unsigned int frame)
+{
+    switch (key)
+    {
+    case GLFW_KEY_SPACE:
+        // the start screen polls input after presenting, i.e. once frame 0 has ended
+        return frame <= 1;
+    case GLFW_KEY_Z:
+        return (frame / 90) % 2 == 0;
+    case GLFW_KEY_X:
+        return (frame / 90) % 2 == 1;
+    case GLFW_KEY_V:
+        return frame % 40 < 20;
+    default:
+        return false;
+    }
+}
+
+bool HeadlessSession::init(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    if (!createContext())
+        return false;
+
+    // colour + depth renderbuffers; the scene never samples them
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenRenderbuffers(1, &colorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+    glGenRenderbuffers(1, &depthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::HEADLESS:: Framebuffer is not complete" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, width, height);
+
+    std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+    lastFrameEnd = std::chrono::steady_clock::now();
+    return true;
+}
+
+void HeadlessSession::endFrame(const RenderStats &stats)
+{
+    glFinish();
+    auto now = std::chrono::steady_clock::now();
+    frameTimesMs.push_back(std::chrono::duration<double, std::milli>(now - lastFrameEnd).count());
+    frameStats.push_back(stats);
+
+    if (!captureDir.empty() && frame % captureEvery == 0)
+        capture();
+
+    frame++;
+    lastFrameEnd = std::chrono::steady_clock::now(); // exclude capture cost from the next frame
+}
+
+void HeadlessSession::finish()
+{
+    if (frameTimesMs.empty())
+        return;
+
+    double total = 0.0, worst = 0.0;
+    for (double t : frameTimesMs)
+    {
+        total += t;
+        worst = std::max(worst, t);
+    }
+    double draws = 0.0, changes = 0.0;
+    for (const RenderStats &stats : frameStats)
+    {
+        draws += stats.drawCalls;
+        changes += stats.stateChanges;
+    }
+    std::cout << "Headless: " << frameTimesMs.size() << " frames, avg " << total / frameTimesMs.size()
+              << " ms, max " << worst << " ms, avg " << draws / frameStats.size() << " draw calls, "
+              << changes / frameStats.size() << " state changes" << std::endl;
+
+    if (!frameLogPath.empty())
+    {
+        std::ofstream log(frameLogPath);
+        if (!log)
+        {
+            std::cerr << "Error: Unable to write frame log: " << frameLogPath << std::endl;
+            return;
+        }
+        log << "frame,ms,draw_calls,state_changes,redundant_skipped,triangles,objects_visible,objects_culled,particles\n";
+        for (size_t i = 0; i < frameTimesMs.size(); i++)
+            log << i << "," << frameTimesMs[i] << "," << frameStats[i].drawCalls << ","
+                << frameStats[i].stateChanges << "," << frameStats[i].redundantSkipped << "," << frameStats[i].triangles << ","
+                << frameStats[i].objectsVisible << "," << frameStats[i].objectsCulled << "," << frameStats[i].particles << "\n";
+    }
+}
+
+void HeadlessSession::destroy()
+{
+    if (FBO != 0)
+    {
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteRenderbuffers(1, &colorRBO);
+        glDeleteRenderbuffers(1, &depthRBO);
+        FBO = 0;
+    }
+#ifdef __linux__
+    if (display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+#else
+    if (window != nullptr)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        window = nullptr;
+    }
+#endif
+}
+
+#ifdef __linux__
+bool HeadlessSession::createContext()
+{
+    // prefer the surfaceless platform: it needs neither X11, Wayland nor a GPU
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cout << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+
+    // surface type defaults to EGL_WINDOW_BIT, which surfaceless displays never offer
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+    EGLConfig eglConfig;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &eglConfig, 1, &numConfigs) || numConfigs == 0)
+    {
+        std::cout << "Failed to choose an EGL config" << std::endl;
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    context = eglCreateContext(display, eglConfig, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cout << "Failed to create a surfaceless EGL context" << std::endl;
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)eglGetProcAddress);
+    return true;
+}
+#else
+bool HeadlessSession::createContext()
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(width, height, "Star Wars Scene (headless)", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    return true;
+}
+#endif
+
+
+void HeadlessSession::capture()
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%05u.png", frame);
+    writePNG(captureDir + name, width, height, pixels);
+}
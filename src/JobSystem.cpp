@@ -0,0 +1,132 @@
+#include "JobSystem.h"
+
+JobSystem jobSystem;
+
+// which system's worker the current thread is, and its queue
+static thread_local const JobSystem *workerOf = nullptr;
+static thread_local unsigned int workerQueue = 0;
+
+void JobSystem::start(unsigned int workers)
+{
+    stop();
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    workers = std::max(workers, 1u);
+
+    stopping = false;
+    queues.resize(1);
+    for (unsigned int i = 0; i < workers; i++)
+        queues.emplace_back(new Queue());
+    for (unsigned int i = 0; i < workers; i++)
+        threads.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+
+void JobSystem::stop()
+{
+    if (threads.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+    threads.clear();
+
+    // anything queued after the workers left runs here
+    while (runOne(0))
+    {
+    }
+    queues.resize(1);
+}
+
+unsigned int JobSystem::queueIndex() const
+{
+    return workerOf == this ? workerQueue : 0;
+}
+
+void JobSystem::run(JobCounter &counter, std::function<void()> job)
+{
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    Queue &queue = *queues[queueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job{std::move(job), &counter});
+    }
+    queued.fetch_add(1);
+
+    // A worker going to sleep counts itself in 'sleeping' before it checks 'queued'
+    // and this reads 'sleeping' after raising 'queued' (both sequentially consistent),
+    // so either it sees the job or it is counted here. Workers that are all awake
+    // cost no lock. Taking the lock keeps the notify from landing between a
+    // sleeper's check and its wait.
+    if (sleeping.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+    unsigned int self = queueIndex();
+    while (!counter.done())
+    {
+        // help with the counter's queued jobs; if none are left, the last ones are running elsewhere
+        if (!runOne(self, &counter))
+            std::this_thread::yield();
+    }
+}
+
+bool JobSystem::runOne(unsigned int self, const JobCounter *only)
+{
+    Job job;
+    bool found = false;
+    size_t count = queues.size();
+    for (size_t i = 0; i < count && !found; i++)
+    {
+        Queue &queue = *queues[(self + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        size_t size = queue.jobs.size();
+        for (size_t n = 0; n < size; n++)
+        {
+            // newest first from the own queue, oldest first from the others
+            auto it = i == 0 ? queue.jobs.begin() + (size - 1 - n) : queue.jobs.begin() + n;
+            if (only && it->counter != only)
+                continue;
+            job = std::move(*it);
+            queue.jobs.erase(it);
+            found = true;
+            break;
+        }
+    }
+    if (!found)
+        return false;
+
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    job.function();
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(unsigned int index)
+{
+    workerOf = this;
+    workerQueue = index;
+    for (;;)
+    {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this]()
+                  { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
@@ -0,0 +1,171 @@
+#include "Mesh.h"
+#include "Simplify.h"
+#include "MeshOptimize.h"
+#include "VertexPacking.h"
+#include "Transforms.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MESH_SSE 1
+#endif
+
+bool packMeshVertices = true;
+
+Mesh::Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+{
+    this->vertices = vertices;
+    this->indices = indices;
+    this->textures = textures;
+
+    setupMesh();
+}
+
+BoundingBox computeBoundingBox(const vector<Vertex> &vertices)
+{
+    BoundingBox box;
+    size_t i = 0;
+#ifdef MESH_SSE
+    if (!vertices.empty())
+    {
+        // the fourth lane reads Normal.x, which follows Position in every vertex, and is ignored
+        static_assert(offsetof(Vertex, Normal) == sizeof(glm::vec3), "Vertex::Position must be followed by Normal");
+        __m128 minP = _mm_loadu_ps(&vertices[0].Position.x);
+        __m128 maxP = minP;
+        for (i = 1; i < vertices.size(); i++)
+        {
+            __m128 p = _mm_loadu_ps(&vertices[i].Position.x);
+            minP = _mm_min_ps(minP, p);
+            maxP = _mm_max_ps(maxP, p);
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, minP);
+        box.min = glm::vec3(lanes[0], lanes[1], lanes[2]);
+        _mm_storeu_ps(lanes, maxP);
+        box.max = glm::vec3(lanes[0], lanes[1], lanes[2]);
+    }
+#endif
+    for (; i < vertices.size(); i++)
+    {
+        box.min = glm::min(box.min, vertices[i].Position);
+        box.max = glm::max(box.max, vertices[i].Position);
+    }
+    return box;
+}
+
+BoundingSphere computeBoundingSphere(const vector<Vertex> &vertices, const BoundingBox &box)
+{
+    BoundingSphere sphere;
+    if (box.empty())
+        return sphere;
+    sphere.center = box.center();
+
+    float radius2 = 0.0f;
+    for (const Vertex &v : vertices)
+    {
+        glm::vec3 d = v.Position - sphere.center;
+        radius2 = std::max(radius2, glm::dot(d, d));
+    }
+    sphere.radius = std::sqrt(radius2);
+    return sphere;
+}
+
+void bindMaterialTextures(Shader &shader, const vector<Texture> &textures, GLStateCache &state)
+{
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    for (unsigned int i = 0; i < textures.size(); i++)
+    {
+        // retrieve texture number (the N in diffuse_textureN)
+        string number;
+        string name = textures[i].type;
+        if (name == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (name == "texture_specular")
+            number = std::to_string(specularNr++);
+
+        shader.setInt(("material." + name + number).c_str(), i);
+        state.bindTexture(i, GL_TEXTURE_2D, textures[i].id);
+    }
+}
+
+void Mesh::Draw(Shader &shader)
+{
+    bindMaterialTextures(shader, textures, glState);
+
+    // draw mesh
+    glState.bindVertexArray(arena().VAO);
+    glState.drawElementsBaseVertex(GL_TRIANGLES, range.indexCount, range.indexType, range.indexOffset(), range.baseVertex);
+}
+
+void Mesh::Submit(RenderQueue &queue, Shader &shader, const glm::mat4 &model, size_t lod) const
+{
+    const MeshLod &level = lods[std::min(lod, lods.size() - 1)];
+    queue.submit(shader, arena().VAO, level.range, textures, packed ? model * dequantize : model);
+}
+
+void Mesh::SubmitInstances(RenderQueue &queue, Shader &shader, const glm::vec3 *positions, const uint32_t *indices, size_t count,
+                           const glm::mat4 &orientation, size_t lod) const
+{
+    const MeshLod &level = lods[std::min(lod, lods.size() - 1)];
+    glm::mat4 matrix = packed ? orientation * dequantize : orientation;
+    queue.submitInstances(shader, arena().VAO, level.range, textures, count, [=](InstanceData *out, size_t begin, size_t end)
+                          {
+        // called by the flush for one batch, already on a worker
+        buildTransforms(indices ? positions : positions + begin, indices ? indices + begin : nullptr, end - begin, matrix,
+                        &out[begin].model, sizeof(InstanceData), nullptr);
+        for (size_t k = begin; k < end; k++)
+        {
+            out[k].materialColor = glm::vec3(0.0f);
+            out[k].emissionColor = glm::vec3(0.0f);
+        } });
+}
+
+void Mesh::setupMesh()
+{
+    box = computeBoundingBox(vertices);
+    bounds = computeBoundingSphere(vertices, box);
+
+    packed = packMeshVertices && canPackVertices(vertices, box);
+    if (packed)
+    {
+        vector<PackedVertex> packedVertices;
+        dequantize = packVertices(vertices, box, packedVertices);
+        range = packedMeshArena.add(packedVertices, indices);
+    }
+    else
+    {
+        range = meshArena.add(vertices, indices);
+    }
+    buildLods();
+}
+
+// triangle fraction of each level after the full mesh
+static const float LOD_RATIOS[] = {0.5f, 0.25f, 0.125f};
+// meshes this small gain nothing from fewer triangles
+static const size_t LOD_MIN_TRIANGLES = 64;
+
+void Mesh::buildLods()
+{
+    lods.assign(1, MeshLod{range, 0.0f});
+
+    // each level simplifies the previous one; its error adds up along the chain
+    vector<unsigned int> previous = indices;
+    float error = 0.0f;
+    for (float ratio : LOD_RATIOS)
+    {
+        size_t target = static_cast<size_t>(indices.size() / 3 * ratio) * 3;
+        if (target < LOD_MIN_TRIANGLES * 3)
+            break;
+        float levelError;
+        vector<unsigned int> simplified = simplifyMesh(vertices, previous, target, &levelError);
+        if (simplified.empty() || simplified.size() > previous.size() * 9 / 10)
+            break; // the simplifier got stuck (e.g. every edge would flip a triangle)
+        optimizeVertexCache(simplified, vertices.size());
+        error += levelError;
+        lods.push_back(MeshLod{arena().addIndices(range, simplified), error});
+        previous.swap(simplified);
+    }
+}
@@ -0,0 +1,159 @@
+#include "MeshArena.h"
+#include "Mesh.h"
+#include "VertexPacking.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <limits>
+
+MeshArena meshArena(VertexFormat::Float);
+MeshArena packedMeshArena(VertexFormat::Packed);
+
+// room for the fighter, an invader and the projectile before the first grow
+static const size_t INITIAL_VERTICES = 1 << 16;
+static const size_t INITIAL_INDEX_BYTES = 3 << 17; // 3 << 16 16-bit indices
+
+MeshRange MeshArena::add(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    return addVertexData(vertices.data(), vertices.size(), indices);
+}
+
+MeshRange MeshArena::add(const std::vector<PackedVertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    return addVertexData(vertices.data(), vertices.size(), indices);
+}
+
+size_t MeshArena::vertexSize() const
+{
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+MeshRange MeshArena::addVertexData(const void *vertices, size_t vertexCount, const std::vector<unsigned int> &indices)
+{
+    if (VAO == 0)
+        create();
+
+    if (verticesUsed + vertexCount > vertexCapacity)
+        grow(VBO, vertexCapacity, verticesUsed, vertexSize(), verticesUsed + vertexCount);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, verticesUsed * vertexSize(), vertexCount * vertexSize(), vertices);
+
+    // indices are relative to baseVertex, so a mesh's own vertex count decides whether 16 bits suffice
+    unsigned int indexType = vertexCount <= std::numeric_limits<uint16_t>::max() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    MeshRange range = addIndexData(indices, indexType, static_cast<int>(verticesUsed));
+    verticesUsed += vertexCount;
+    return range;
+}
+
+MeshRange MeshArena::addIndices(const MeshRange &base, const std::vector<unsigned int> &indices)
+{
+    return addIndexData(indices, base.indexType, base.baseVertex);
+}
+
+MeshRange MeshArena::addIndexData(const std::vector<unsigned int> &indices, unsigned int indexType, int baseVertex)
+{
+    MeshRange range;
+    range.indexType = indexType;
+    range.indexCount = static_cast<unsigned int>(indices.size());
+    range.baseVertex = baseVertex;
+
+    // draw offsets must be a multiple of the index size
+    size_t indexSize = range.indexSize();
+    size_t offset = (indexBytesUsed + indexSize - 1) / indexSize * indexSize;
+    size_t bytes = indices.size() * indexSize;
+    if (offset + bytes > indexCapacity)
+        grow(EBO, indexCapacity, indexBytesUsed, 1, offset + bytes);
+
+    // indices go through GL_COPY_WRITE_BUFFER: GL_ELEMENT_ARRAY_BUFFER would
+    // rebind the element buffer of whatever VAO is currently bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, shortIndices.data());
+    }
+    else
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, indices.data());
+    }
+
+    range.firstIndex = static_cast<unsigned int>(offset / indexSize);
+    indexBytesUsed = offset + bytes;
+    return range;
+}
+
+void MeshArena::destroy()
+{
+    if (VAO == 0)
+        return;
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VAO = VBO = EBO = 0;
+    vertexCapacity = indexCapacity = 0;
+    verticesUsed = indexBytesUsed = 0;
+}
+
+void MeshArena::create()
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    vertexCapacity = INITIAL_VERTICES;
+    indexCapacity = INITIAL_INDEX_BYTES;
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * vertexSize(), NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity, NULL, GL_STATIC_DRAW);
+
+    setupAttributes();
+}
+
+// Move the contents into a buffer at least twice as large and point the VAO at it
+void MeshArena::grow(unsigned int &buffer, size_t &capacity, size_t used, size_t elementSize, size_t required)
+{
+    size_t newCapacity = std::max(capacity * 2, required);
+
+    unsigned int newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * elementSize, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used * elementSize);
+    glDeleteBuffers(1, &buffer);
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+    setupAttributes();
+}
+
+void MeshArena::setupAttributes()
+{
+    glState.bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    if (format == VertexFormat::Packed)
+    {
+        // same shader inputs: unorm positions (the mesh's dequantize matrix scales them back),
+        // snorm normals and half-float texture coords
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, texCoords));
+    }
+    else
+    {
+        // vertex positions
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+        // vertex normals
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+        // vertex texture coords
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+    }
+
+    glState.bindVertexArray(0);
+}
@@ -0,0 +1,282 @@
+#include "MeshOptimize.h"
+
+#include <algorithm>
+#include <cmath>
+
+// cache size Forsyth's scores are tuned for (an LRU model, larger than the FIFO used for analysis)
+static const int FORSYTH_CACHE_SIZE = 32;
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize)
+{
+    VertexCacheStats stats;
+    if (indices.empty())
+        return stats;
+
+    // a vertex is in the FIFO while fewer than cacheSize misses happened since it entered
+    std::vector<unsigned int> enteredAt(vertexCount, 0);
+    std::vector<unsigned char> referenced(vertexCount, 0);
+    unsigned int time = cacheSize + 1, misses = 0, unique = 0;
+    for (unsigned int index : indices)
+    {
+        if (time - enteredAt[index] > cacheSize)
+        {
+            enteredAt[index] = time++;
+            misses++;
+        }
+        if (!referenced[index])
+        {
+            referenced[index] = 1;
+            unique++;
+        }
+    }
+    stats.acmr = float(misses) / float(indices.size() / 3);
+    stats.atvr = float(misses) / float(unique);
+    return stats;
+}
+
+static float vertexScore(int cachePosition, unsigned int remaining)
+{
+    if (remaining == 0)
+        return -1.0f; // no triangle left to draw with this vertex
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // the last triangle's vertices get a fixed score so the same triangle area isn't picked right back
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = std::pow(1.0f - float(cachePosition - 3) / float(FORSYTH_CACHE_SIZE - 3), 1.5f);
+    }
+    // vertices with few triangles left are finished off first, so they don't end up as lonely leftovers
+    return score + 2.0f * std::pow(float(remaining), -0.5f);
+}
+
+void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // the triangles of each vertex; the first remaining[v] of them are still to be emitted
+    std::vector<unsigned int> start(vertexCount + 1, 0), remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+        remaining[index]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        start[v + 1] = start[v] + remaining[v];
+    std::vector<unsigned int> vertexTriangles(indices.size());
+    {
+        std::vector<unsigned int> fill(start.begin(), start.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+            for (int k = 0; k < 3; k++)
+                vertexTriangles[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        scores[v] = vertexScore(-1, remaining[v]);
+
+    auto triangleScore = [&](unsigned int t)
+    {
+        return scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+    };
+
+    std::vector<unsigned char> emitted(triangleCount, 0);
+    std::vector<unsigned int> result, cache, newCache;
+    result.reserve(indices.size());
+
+    long best = -1;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (triangleScore(static_cast<unsigned int>(t)) > bestScore)
+        {
+            bestScore = triangleScore(static_cast<unsigned int>(t));
+            best = static_cast<long>(t);
+        }
+    }
+
+    size_t scanCursor = 0;
+    while (result.size() < indices.size())
+    {
+        if (best < 0)
+        {
+            // nothing in the cache touches a remaining triangle: continue with the next one in input order
+            while (emitted[scanCursor])
+                scanCursor++;
+            best = static_cast<long>(scanCursor);
+        }
+
+        unsigned int t = static_cast<unsigned int>(best);
+        emitted[t] = 1;
+        const unsigned int *corners = &indices[t * 3];
+        result.insert(result.end(), corners, corners + 3);
+
+        // take the triangle off its vertices' lists
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = corners[k];
+            unsigned int *list = &vertexTriangles[start[v]];
+            for (unsigned int i = 0; i < remaining[v]; i++)
+            {
+                if (list[i] == t)
+                {
+                    std::swap(list[i], list[remaining[v] - 1]);
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+
+        // the triangle's vertices move to the front of the cache
+        newCache.clear();
+        for (int k = 0; k < 3; k++)
+            if (std::find(newCache.begin(), newCache.end(), corners[k]) == newCache.end())
+                newCache.push_back(corners[k]);
+        size_t cornerCount = newCache.size();
+        for (unsigned int v : cache)
+            if (std::find(newCache.begin(), newCache.begin() + cornerCount, v) == newCache.begin() + cornerCount)
+                newCache.push_back(v);
+        for (size_t i = FORSYTH_CACHE_SIZE; i < newCache.size(); i++)
+        {
+            cachePosition[newCache[i]] = -1;
+            scores[newCache[i]] = vertexScore(-1, remaining[newCache[i]]);
+        }
+        if (newCache.size() > FORSYTH_CACHE_SIZE)
+            newCache.resize(FORSYTH_CACHE_SIZE);
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            cachePosition[newCache[i]] = static_cast<int>(i);
+            scores[newCache[i]] = vertexScore(static_cast<int>(i), remaining[newCache[i]]);
+        }
+        cache.swap(newCache);
+
+        // next: the best remaining triangle that uses a cached vertex
+        best = -1;
+        bestScore = -1.0f;
+        for (unsigned int v : cache)
+        {
+            for (unsigned int i = 0; i < remaining[v]; i++)
+            {
+                unsigned int candidate = vertexTriangles[start[v] + i];
+                float score = triangleScore(candidate);
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = candidate;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, float threshold)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // clusters: a new one starts wherever a triangle misses the cache with all three vertices
+    const unsigned int cacheSize = 16;
+    std::vector<unsigned int> enteredAt(vertices.size(), 0);
+    unsigned int time = cacheSize + 1;
+    std::vector<size_t> clusterStart;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int index = indices[t * 3 + k];
+            if (time - enteredAt[index] > cacheSize)
+            {
+                enteredAt[index] = time++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3)
+            clusterStart.push_back(t);
+    }
+    clusterStart.push_back(triangleCount);
+    size_t clusterCount = clusterStart.size() - 1;
+    if (clusterCount < 2)
+        return;
+
+    // area-weighted centroid and normal of each cluster and of the whole mesh
+    std::vector<glm::vec3> centroid(clusterCount, glm::vec3(0.0f)), normal(clusterCount, glm::vec3(0.0f));
+    std::vector<float> area(clusterCount, 0.0f);
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++)
+        {
+            const glm::vec3 &a = vertices[indices[t * 3]].Position;
+            const glm::vec3 &b = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3 &d = vertices[indices[t * 3 + 2]].Position;
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(n);
+            centroid[c] += (a + b + d) * (triangleArea / 3.0f);
+            normal[c] += n;
+            area[c] += triangleArea;
+        }
+        meshCentroid += centroid[c];
+        meshArea += area[c];
+        if (area[c] > 0.0f)
+            centroid[c] = centroid[c] * (1.0f / area[c]);
+    }
+    if (meshArea > 0.0f)
+        meshCentroid = meshCentroid * (1.0f / meshArea);
+
+    // clusters on the outside of the mesh, facing away from its centre, occlude the others: draw them first
+    std::vector<float> outward(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        float length = glm::length(normal[c]);
+        if (length > 0.0f)
+            outward[c] = glm::dot(centroid[c] - meshCentroid, normal[c] * (1.0f / length));
+    }
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                     { return outward[a] > outward[b]; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(indices.size());
+    for (size_t c : order)
+        sorted.insert(sorted.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+
+    // the cluster seams cost some cache hits; keep the new order only if that stays small
+    if (analyzeVertexCache(sorted, vertices.size()).acmr <= analyzeVertexCache(indices, vertices.size()).acmr * threshold)
+        indices.swap(sorted);
+}
+
+void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+{
+    const unsigned int unused = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+std::pair<VertexCacheStats, VertexCacheStats> optimizeMesh(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+{
+    VertexCacheStats before = analyzeVertexCache(indices, vertices.size());
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+    return {before, analyzeVertexCache(indices, vertices.size())};
+}
@@ -0,0 +1,270 @@
+#include "Model.h"
+
+#include <algorithm>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "MeshOptimize.h"
+#include "stb_image.h"
+
+static unsigned int TextureFromFile(const char *path, const string &directory)
+{
+    string filename = string(path);
+    filename = directory + '/' + filename;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        GLenum format;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+        else if (nrComponents == 4)
+            format = GL_RGBA;
+
+        glState.bindTexture(0, GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
+
+static vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName, vector<Texture> &textures_loaded, const string &directory)
+{
+    vector<Texture> textures;
+    for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
+    {
+        aiString str;
+        mat->GetTexture(type, i, &str);
+        bool skip = false;
+        for (unsigned int j = 0; j < textures_loaded.size(); j++)
+        {
+            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
+            {
+                textures.push_back(textures_loaded[j]);
+                skip = true;
+                break;
+            }
+        }
+        if (!skip)
+        { // if texture hasn't been loaded already, load it
+            Texture texture;
+            texture.id = TextureFromFile(str.C_Str(), directory);
+            texture.type = typeName;
+            texture.path = str.C_Str();
+            textures.push_back(texture);
+            textures_loaded.push_back(texture);
+        }
+    }
+    return textures;
+}
+
+// Models already imported, by path. Their meshes are in meshArena and their
+// textures uploaded, so every later instance (each invader, each restart) copies them.
+struct LoadedModel
+{
+    vector<Mesh> meshes;
+    vector<Texture> textures_loaded;
+    string directory;
+    BoundingBox box;
+    BoundingSphere bounds;
+    vector<float> lodErrors;
+};
+static std::map<string, LoadedModel> loadedModels;
+
+void Model::clearCache()
+{
+    loadedModels.clear();
+}
+
+void Model::loadModel(string path)
+{
+    auto cached = loadedModels.find(path);
+    if (cached != loadedModels.end())
+    {
+        meshes = cached->second.meshes;
+        textures_loaded = cached->second.textures_loaded;
+        directory = cached->second.directory;
+        box = cached->second.box;
+        bounds = cached->second.bounds;
+        lodErrors = cached->second.lodErrors;
+        setOrientation(orientation);
+        return;
+    }
+
+    Assimp::Importer import;
+    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
+        return;
+    }
+    directory = path.substr(0, path.find_last_of('/'));
+
+    processNode(scene->mRootNode, scene);
+
+    // each mesh measured its own box in processMesh; the sphere is centred on their union
+    for (const Mesh &mesh : meshes)
+        box.merge(mesh.box);
+    bounds.center = box.empty() ? glm::vec3(0.0f) : box.center();
+    for (const Mesh &mesh : meshes)
+        bounds.radius = std::max(bounds.radius, computeBoundingSphere(mesh.vertices, box).radius);
+    setOrientation(orientation);
+
+    // meshes built their levels of detail in processMesh; a model level is as coarse as its worst mesh
+    for (const Mesh &mesh : meshes)
+    {
+        if (lodErrors.size() < mesh.lods.size())
+            lodErrors.resize(mesh.lods.size(), 0.0f);
+        for (size_t i = 0; i < mesh.lods.size(); i++)
+            lodErrors[i] = std::max(lodErrors[i], mesh.lods[i].error);
+    }
+    // meshes with fewer levels keep drawing their coarsest one, so later levels are at least as bad
+    for (size_t i = 1; i < lodErrors.size(); i++)
+        lodErrors[i] = std::max(lodErrors[i], lodErrors[i - 1]);
+
+    loadedModels[path] = {meshes, textures_loaded, directory, box, bounds, lodErrors};
+}
+
+size_t Model::selectLod(float pixelsPerUnit, float maxPixelError) const
+{
+    float scale = bounds.radius > 0.0f ? orientedBounds.radius / bounds.radius : 1.0f;
+    size_t lod = 0;
+    while (lod + 1 < lodErrors.size() && lodErrors[lod + 1] * scale * pixelsPerUnit <= maxPixelError)
+        lod++;
+    return lod;
+}
+
+void Model::lodDistancesSquared(float pixelsAtUnitDistance, float maxPixelError, vector<float> &distances) const
+{
+    float scale = bounds.radius > 0.0f ? orientedBounds.radius / bounds.radius : 1.0f;
+    distances.assign(1, 0.0f);
+    float farthest = 0.0f;
+    for (size_t lod = 1; lod < lodErrors.size(); lod++)
+    {
+        // selectLod stops at the first level too coarse, so each level starts no nearer than the last
+        farthest = std::max(farthest, lodErrors[lod] * scale * pixelsAtUnitDistance / maxPixelError);
+        // and it treats anything nearer than 0.1 as 0.1 away
+        distances.push_back(farthest <= 0.1f ? 0.0f : farthest * farthest);
+    }
+}
+
+void Model::processNode(aiNode *node, const aiScene *scene)
+{
+    // process all the node's meshes (if any)
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+    {
+        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
+        meshes.push_back(processMesh(mesh, scene));
+    }
+    // then do the same for each of its children
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+    {
+        processNode(node->mChildren[i], scene);
+    }
+}
+
+Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+{
+    // data to fill
+    vector<Vertex> vertices;
+    vector<unsigned int> indices;
+    vector<Texture> textures;
+
+    // walk through each of the mesh's vertices
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+        Vertex vertex;
+        glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
+        // positions
+        vector.x = mesh->mVertices[i].x;
+        vector.y = mesh->mVertices[i].y;
+        vector.z = mesh->mVertices[i].z;
+        vertex.Position = vector;
+        // normals
+        if (mesh->HasNormals())
+        {
+            vector.x = mesh->mNormals[i].x;
+            vector.y = mesh->mNormals[i].y;
+            vector.z = mesh->mNormals[i].z;
+            vertex.Normal = vector;
+        }
+        // texture coordinates
+        if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
+        {
+            glm::vec2 vec;
+            // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't
+            // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
+            vec.x = mesh->mTextureCoords[0][i].x;
+            vec.y = mesh->mTextureCoords[0][i].y;
+            vertex.TexCoords = vec;
+        }
+        else
+            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+
+        vertices.push_back(vertex);
+    }
+    // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
+    bool trianglesOnly = true; // aiProcess_Triangulate leaves point and line faces alone
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        aiFace face = mesh->mFaces[i];
+        trianglesOnly = trianglesOnly && face.mNumIndices == 3;
+        // retrieve all indices of the face and store them in the indices vector
+        for (unsigned int j = 0; j < face.mNumIndices; j++)
+            indices.push_back(face.mIndices[j]);
+    }
+    // reorder triangles for the post-transform cache and vertices for fetch locality
+    if (trianglesOnly && !indices.empty())
+    {
+        std::pair<VertexCacheStats, VertexCacheStats> stats = optimizeMesh(vertices, indices);
+        cout << "Mesh " << mesh->mName.C_Str() << " (" << indices.size() / 3 << " triangles): ACMR "
+             << stats.first.acmr << " -> " << stats.second.acmr << ", ATVR "
+             << stats.first.atvr << " -> " << stats.second.atvr << endl;
+    }
+    // process materials
+    aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+    // we assume a convention for sampler names in the shaders. Each diffuse texture should be named
+    // as 'texture_diffuseN' where N is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER.
+    // Same applies to other texture as the following list summarizes:
+    // diffuse: texture_diffuseN
+    // specular: texture_specularN
+    // normal: texture_normalN
+
+    // 1. diffuse maps
+    vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", textures_loaded, directory);
+    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+    // 2. specular maps
+    vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", textures_loaded, directory);
+    textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+    // 3. normal maps
+    std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", textures_loaded, directory);
+    textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+    // 4. height maps
+    std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", textures_loaded, directory);
+    textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+
+    // return a mesh object created from the extracted mesh data
+    return Mesh(vertices, indices, textures);
+}
@@ -0,0 +1,329 @@
+#include "Particles.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PARTICLES_SSE 1
+#endif
+
+// Transform feedback outputs of shaders/particle_update.vs, in Particle order
+static const char *const UPDATE_VARYINGS[] = {"Position", "Age", "Velocity", "Lifetime", "Color", "Size"};
+
+static uint32_t packColor(const glm::vec3 &color)
+{
+    auto channel = [](float v)
+    { return static_cast<uint32_t>(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (255u << 24);
+}
+
+// Compile a vertex-only program whose outputs are captured into one interleaved buffer
+static unsigned int createFeedbackProgram(const char *vertexPath)
+{
+    std::ifstream file(vertexPath);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string code = stream.str();
+    if (!file)
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << vertexPath << std::endl;
+    const char *source = code.c_str();
+
+    GLint success;
+    GLchar infoLog[1024];
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &source, NULL);
+    glCompileShader(vertex);
+    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(vertex, 1024, NULL, infoLog);
+        std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: VERTEX\n" << infoLog << std::endl;
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    // must be set before linking
+    glTransformFeedbackVaryings(program, 6, UPDATE_VARYINGS, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << std::endl;
+    }
+    glDeleteShader(vertex);
+    return program;
+}
+
+void ParticleSimulator::resize(size_t capacity)
+{
+    for (std::vector<float> *array : {&px, &py, &pz, &vx, &vy, &vz, &age, &lifetime, &size})
+        array->assign(capacity, 0.0f);
+    color.assign(capacity, 0);
+}
+
+void ParticleSimulator::set(size_t slot, const Particle &particle)
+{
+    px[slot] = particle.position.x;
+    py[slot] = particle.position.y;
+    pz[slot] = particle.position.z;
+    vx[slot] = particle.velocity.x;
+    vy[slot] = particle.velocity.y;
+    vz[slot] = particle.velocity.z;
+    age[slot] = particle.age;
+    lifetime[slot] = particle.lifetime;
+    color[slot] = particle.color;
+    size[slot] = particle.size;
+}
+
+void ParticleSimulator::update(float deltaTime, float damping, size_t count, Particle *out)
+{
+    size_t i = 0;
+#ifdef PARTICLES_SSE
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 damp = _mm_set1_ps(damping);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 velX = _mm_mul_ps(_mm_loadu_ps(&vx[i]), damp);
+        __m128 velY = _mm_mul_ps(_mm_loadu_ps(&vy[i]), damp);
+        __m128 velZ = _mm_mul_ps(_mm_loadu_ps(&vz[i]), damp);
+        __m128 posX = _mm_add_ps(_mm_loadu_ps(&px[i]), _mm_mul_ps(velX, dt));
+        __m128 posY = _mm_add_ps(_mm_loadu_ps(&py[i]), _mm_mul_ps(velY, dt));
+        __m128 posZ = _mm_add_ps(_mm_loadu_ps(&pz[i]), _mm_mul_ps(velZ, dt));
+        __m128 ages = _mm_add_ps(_mm_loadu_ps(&age[i]), dt);
+        _mm_storeu_ps(&vx[i], velX);
+        _mm_storeu_ps(&vy[i], velY);
+        _mm_storeu_ps(&vz[i], velZ);
+        _mm_storeu_ps(&px[i], posX);
+        _mm_storeu_ps(&py[i], posY);
+        _mm_storeu_ps(&pz[i], posZ);
+        _mm_storeu_ps(&age[i], ages);
+
+        if (out)
+        {
+            // transpose to one (position, age) and one (velocity, lifetime) vector per particle
+            __m128 lifetimes = _mm_loadu_ps(&lifetime[i]);
+            _MM_TRANSPOSE4_PS(posX, posY, posZ, ages);
+            _MM_TRANSPOSE4_PS(velX, velY, velZ, lifetimes);
+            const __m128 first[4] = {posX, posY, posZ, ages};
+            const __m128 second[4] = {velX, velY, velZ, lifetimes};
+            for (int lane = 0; lane < 4; lane++)
+            {
+                float *dst = reinterpret_cast<float *>(out + i + lane);
+                _mm_storeu_ps(dst, first[lane]);
+                _mm_storeu_ps(dst + 4, second[lane]);
+                out[i + lane].color = color[i + lane];
+                out[i + lane].size = size[i + lane];
+            }
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        vx[i] *= damping;
+        vy[i] *= damping;
+        vz[i] *= damping;
+        px[i] += vx[i] * deltaTime;
+        py[i] += vy[i] * deltaTime;
+        pz[i] += vz[i] * deltaTime;
+        age[i] += deltaTime;
+        if (out)
+            out[i] = Particle{glm::vec3(px[i], py[i], pz[i]), age[i], glm::vec3(vx[i], vy[i], vz[i]), lifetime[i], color[i], size[i]};
+    }
+}
+
+void ParticleSystem::init(size_t particleCapacity, Backend particleBackend)
+{
+    capacity = particleCapacity;
+    backend = particleBackend;
+    clear();
+
+    glGenBuffers(2, buffers);
+    glGenVertexArrays(2, VAOs);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Particle), NULL, backend == Backend::Cpu ? GL_STREAM_DRAW : GL_DYNAMIC_COPY);
+
+        // the same layout feeds the update and the render program
+        glState.bindVertexArray(VAOs[i]);
+        for (int location = 0; location <= 5; location++)
+            glEnableVertexAttribArray(location);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, position));
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, age));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, velocity));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, lifetime));
+        glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(Particle), (void *)offsetof(Particle, color));
+        glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), (void *)offsetof(Particle, size));
+    }
+    glState.bindVertexArray(0);
+
+    if (backend == Backend::TransformFeedback)
+    {
+        updateProgram = createFeedbackProgram("shaders/particle_update.vs");
+        deltaTimeLocation = glGetUniformLocation(updateProgram, "deltaTime");
+        dampingLocation = glGetUniformLocation(updateProgram, "damping");
+    }
+    else
+    {
+        simulator.resize(capacity);
+    }
+
+    // the sprite size comes from gl_PointSize
+    glState.setEnabled(GL_PROGRAM_POINT_SIZE, true);
+}
+
+void ParticleSystem::destroy()
+{
+    if (buffers[0] == 0)
+        return;
+    glDeleteBuffers(2, buffers);
+    glDeleteVertexArrays(2, VAOs);
+    if (updateProgram != 0)
+        glDeleteProgram(updateProgram);
+    buffers[0] = buffers[1] = VAOs[0] = VAOs[1] = 0;
+    updateProgram = 0;
+    simulator.resize(0);
+}
+
+void ParticleSystem::clear()
+{
+    head = active = 0;
+    current = 0;
+    aliveUntil = time;
+    pending.clear();
+}
+
+void ParticleSystem::emit(const Particle &particle)
+{
+    pending.push_back(particle);
+}
+
+void ParticleSystem::emitBurst(const glm::vec3 &center, size_t count, float minSpeed, float maxSpeed, float minLifetime, float maxLifetime,
+                               const glm::vec3 &innerColor, const glm::vec3 &outerColor, float size)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        // uniform direction on the sphere; the fastest particles take the outer colour
+        float z = random.range(-1.0f, 1.0f);
+        float angle = random.range(0.0f, 2.0f * glm::pi<float>());
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        glm::vec3 direction(r * std::cos(angle), r * std::sin(angle), z);
+        float t = random.nextFloat();
+        glm::vec3 color = innerColor + (outerColor - innerColor) * t;
+        emit(Particle{center, 0.0f, direction * (minSpeed + (maxSpeed - minSpeed) * t), random.range(minLifetime, maxLifetime),
+                      packColor(color), size});
+    }
+}
+
+void ParticleSystem::emitTrail(const glm::vec3 &position, const glm::vec3 &velocity, float rate, float deltaTime, float &carry,
+                               float lifetime, const glm::vec3 &color, float size)
+{
+    carry += rate * deltaTime;
+    float spread = glm::length(velocity) * 0.15f;
+    uint32_t packed = packColor(color);
+    for (; carry >= 1.0f; carry -= 1.0f)
+    {
+        glm::vec3 jitter(random.range(-spread, spread), random.range(-spread, spread), random.range(-spread, spread));
+        emit(Particle{position, 0.0f, velocity + jitter, lifetime * random.range(0.7f, 1.0f), packed, size});
+    }
+}
+
+void ParticleSystem::upload(size_t slot, const Particle *particles, size_t count)
+{
+    if (count == 0)
+        return;
+    if (backend == Backend::Cpu)
+    {
+        for (size_t i = 0; i < count; i++)
+            simulator.set(slot + i, particles[i]);
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+    glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(Particle), count * sizeof(Particle), particles);
+}
+
+void ParticleSystem::writePending()
+{
+    if (pending.empty())
+        return;
+
+    // more than the whole ring: only the newest survive
+    const Particle *particles = pending.data();
+    size_t count = pending.size();
+    if (count > capacity)
+    {
+        particles += count - capacity;
+        count = capacity;
+    }
+    for (size_t i = 0; i < count; i++)
+        aliveUntil = std::max(aliveUntil, time + particles[i].lifetime - particles[i].age);
+
+    size_t first = std::min(count, capacity - head);
+    upload(head, particles, first);
+    upload(0, particles + first, count - first);
+    head = (head + count) % capacity;
+    active = std::min(capacity, active + count);
+    pending.clear();
+}
+
+void ParticleSystem::update(GLStateCache &state, float deltaTime)
+{
+    time += deltaTime;
+    // once everything has died the ring starts over, so idle frames cost nothing
+    if (active > 0 && time >= aliveUntil)
+        head = active = 0;
+    writePending();
+    if (active == 0)
+        return;
+
+    float damping = std::exp(-deltaTime / PARTICLE_DRAG_TIME);
+    if (backend == Backend::Cpu)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        void *mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, active * sizeof(Particle), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        simulator.update(deltaTime, damping, active, static_cast<Particle *>(mapped));
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        return;
+    }
+
+    // read the current buffer, capture into the other one
+    state.useProgram(updateProgram);
+    glUniform1f(deltaTimeLocation, deltaTime);
+    glUniform1f(dampingLocation, damping);
+    state.bindVertexArray(VAOs[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[1 - current]);
+    state.setEnabled(GL_RASTERIZER_DISCARD, true);
+    glBeginTransformFeedback(GL_POINTS);
+    state.drawArrays(GL_POINTS, 0, static_cast<GLsizei>(active));
+    glEndTransformFeedback();
+    state.setEnabled(GL_RASTERIZER_DISCARD, false);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    current = 1 - current;
+}
+
+void ParticleSystem::draw(GLStateCache &state, Shader &shader, const glm::mat4 &view, const glm::mat4 &projection, float viewportHeight)
+{
+    if (active == 0)
+        return;
+
+    state.useProgram(shader.ID);
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    shader.setFloat("viewportHeight", viewportHeight);
+    state.bindVertexArray(VAOs[current]);
+
+    state.setEnabled(GL_BLEND, true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE);
+    state.depthMask(false);
+    state.drawArrays(GL_POINTS, 0, static_cast<GLsizei>(active));
+    state.depthMask(true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    state.frame.particles += static_cast<unsigned int>(active);
+}
@@ -0,0 +1,278 @@
+#include "Procedural.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    // Writes vertices and triangles sequentially into the caller's buffers
+    template <typename Index>
+    struct GeometryWriter
+    {
+        Vertex *vertices;
+        Index *indices;
+        Index base;
+        size_t vertexCount = 0;
+
+        GeometryWriter(Vertex *vertices, Index *indices, Index base) : vertices(vertices), indices(indices), base(base) {}
+
+        Index vertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &texCoords)
+        {
+            vertices[vertexCount] = Vertex{position, normal, texCoords};
+            return static_cast<Index>(base + vertexCount++);
+        }
+
+        void triangle(Index a, Index b, Index c)
+        {
+            *indices++ = a;
+            *indices++ = b;
+            *indices++ = c;
+        }
+
+        // Quads between two rings of the same layout, upper above lower
+        void band(Index upper, Index lower, int segments, bool seam)
+        {
+            for (int j = 0; j < segments; j++)
+            {
+                Index next = static_cast<Index>(seam ? j + 1 : (j + 1) % segments);
+                triangle(lower + j, upper + j, lower + next);
+                triangle(upper + j, upper + next, lower + next);
+            }
+        }
+
+        // Triangles from a centre to a ring; up selects which side faces out
+        void fan(Index centre, Index ring, int segments, bool seam, bool up, bool centrePerSegment = false)
+        {
+            for (int j = 0; j < segments; j++)
+            {
+                Index next = static_cast<Index>(seam ? j + 1 : (j + 1) % segments);
+                Index c = static_cast<Index>(centrePerSegment ? centre + j : centre);
+                if (up)
+                    triangle(c, ring + next, ring + j);
+                else
+                    triangle(c, ring + j, ring + next);
+            }
+        }
+    };
+
+    float segmentAngle(float segment, int segments)
+    {
+        return 2.0f * glm::pi<float>() * segment / segments;
+    }
+
+    // Angle of ring column j; the seam column repeats column 0 exactly, so positions still weld
+    float columnAngle(int j, int segments)
+    {
+        return segmentAngle(static_cast<float>(j % segments), segments);
+    }
+
+    template <typename Index>
+    void checkIndexRange(Index baseVertex, GeometrySize size)
+    {
+        (void)baseVertex;
+        (void)size;
+        assert(baseVertex + size.vertexCount - 1 <= std::numeric_limits<Index>::max());
+    }
+
+    // One horizontal ring of a shape of revolution
+    struct Ring
+    {
+        float y;
+        float radius;
+        glm::vec2 normal; // (radial, y)
+        float v;
+    };
+
+    // Poles at top and bottom with ringCount rings between them (sphere, capsule)
+    template <typename Index, typename RingAt>
+    void generateRevolution(GeometryWriter<Index> &out, float top, float bottom, int slices, int ringCount, bool texCoords, RingAt ringAt)
+    {
+        int poles = texCoords ? slices : 1;
+        Index topPole = static_cast<Index>(out.base + out.vertexCount);
+        for (int j = 0; j < poles; j++)
+            out.vertex(glm::vec3(0.0f, top, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2((j + 0.5f) / slices, 1.0f));
+
+        Index firstRing = static_cast<Index>(out.base + out.vertexCount);
+        int columns = static_cast<int>(ringColumns(slices, texCoords));
+        for (int k = 0; k < ringCount; k++)
+        {
+            Ring ring = ringAt(k);
+            for (int j = 0; j < columns; j++)
+            {
+                float angle = columnAngle(j, slices);
+                glm::vec3 direction(std::cos(angle), 0.0f, std::sin(angle));
+                out.vertex(glm::vec3(direction.x * ring.radius, ring.y, direction.z * ring.radius),
+                           glm::vec3(direction.x * ring.normal.x, ring.normal.y, direction.z * ring.normal.x),
+                           texCoords ? glm::vec2(float(j) / slices, ring.v) : glm::vec2(0.0f));
+            }
+        }
+
+        Index bottomPole = static_cast<Index>(out.base + out.vertexCount);
+        for (int j = 0; j < poles; j++)
+            out.vertex(glm::vec3(0.0f, bottom, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec2((j + 0.5f) / slices, 0.0f));
+
+        out.fan(topPole, firstRing, slices, texCoords, true, texCoords);
+        for (int k = 0; k + 1 < ringCount; k++)
+            out.band(static_cast<Index>(firstRing + k * columns), static_cast<Index>(firstRing + (k + 1) * columns), slices, texCoords);
+        out.fan(bottomPole, static_cast<Index>(firstRing + (ringCount - 1) * columns), slices, texCoords, false, texCoords);
+    }
+}
+
+template <typename Index>
+void generateCylinder(float height, float radius, int segments, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, cylinderSize(segments, texCoords));
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+    float halfHeight = height / 2.0f;
+    int columns = static_cast<int>(ringColumns(segments, texCoords));
+
+    // side: bottom ring, then top ring
+    Index side = static_cast<Index>(baseVertex);
+    for (int row = 0; row < 2; row++)
+    {
+        for (int j = 0; j < columns; j++)
+        {
+            float angle = columnAngle(j, segments);
+            glm::vec3 normal(std::cos(angle), 0.0f, std::sin(angle));
+            out.vertex(glm::vec3(normal.x * radius, row ? halfHeight : -halfHeight, normal.z * radius), normal,
+                       texCoords ? glm::vec2(float(j) / segments, float(row)) : glm::vec2(0.0f));
+        }
+    }
+    out.band(static_cast<Index>(side + columns), side, segments, texCoords);
+
+    // caps: a centre and a closed ring each, with planar texture coordinates
+    for (int cap = 0; cap < 2; cap++)
+    {
+        float y = cap ? halfHeight : -halfHeight;
+        glm::vec3 normal(0.0f, cap ? 1.0f : -1.0f, 0.0f);
+        Index centre = out.vertex(glm::vec3(0.0f, y, 0.0f), normal, texCoords ? glm::vec2(0.5f) : glm::vec2(0.0f));
+        for (int j = 0; j < segments; j++)
+        {
+            float angle = columnAngle(j, segments);
+            glm::vec2 direction(std::cos(angle), std::sin(angle));
+            out.vertex(glm::vec3(direction.x * radius, y, direction.y * radius), normal,
+                       texCoords ? glm::vec2(0.5f) + direction * 0.5f : glm::vec2(0.0f));
+        }
+        out.fan(centre, static_cast<Index>(centre + 1), segments, false, cap == 1);
+    }
+}
+
+template <typename Index>
+void generateCone(float height, float radius, int segments, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, coneSize(segments, texCoords));
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+    float halfHeight = height / 2.0f;
+    int columns = static_cast<int>(ringColumns(segments, texCoords));
+
+    // the slanted normal: radial part scaled by the height, upward part by the radius
+    glm::vec2 slope = glm::normalize(glm::vec2(height, radius));
+    auto sideNormal = [&](float angle)
+    {
+        return glm::vec3(std::cos(angle) * slope.x, slope.y, std::sin(angle) * slope.x);
+    };
+
+    // one apex per segment, normal in the middle of its triangle
+    Index apex = static_cast<Index>(baseVertex);
+    for (int j = 0; j < segments; j++)
+        out.vertex(glm::vec3(0.0f, halfHeight, 0.0f), sideNormal(segmentAngle(j + 0.5f, segments)),
+                   texCoords ? glm::vec2((j + 0.5f) / segments, 1.0f) : glm::vec2(0.0f));
+    Index rim = static_cast<Index>(baseVertex + out.vertexCount);
+    for (int j = 0; j < columns; j++)
+    {
+        float angle = columnAngle(j, segments);
+        out.vertex(glm::vec3(std::cos(angle) * radius, -halfHeight, std::sin(angle) * radius), sideNormal(angle),
+                   texCoords ? glm::vec2(float(j) / segments, 0.0f) : glm::vec2(0.0f));
+    }
+    out.fan(apex, rim, segments, texCoords, true, true);
+
+    Index centre = out.vertex(glm::vec3(0.0f, -halfHeight, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), texCoords ? glm::vec2(0.5f) : glm::vec2(0.0f));
+    for (int j = 0; j < segments; j++)
+    {
+        float angle = columnAngle(j, segments);
+        glm::vec2 direction(std::cos(angle), std::sin(angle));
+        out.vertex(glm::vec3(direction.x * radius, -halfHeight, direction.y * radius), glm::vec3(0.0f, -1.0f, 0.0f),
+                   texCoords ? glm::vec2(0.5f) + direction * 0.5f : glm::vec2(0.0f));
+    }
+    out.fan(centre, static_cast<Index>(centre + 1), segments, false, false);
+}
+
+template <typename Index>
+void generateSphere(float radius, int slices, int stacks, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, sphereSize(slices, stacks, texCoords));
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+    generateRevolution(out, radius, -radius, slices, stacks - 1, texCoords, [&](int k)
+                       {
+                           float phi = glm::pi<float>() * (k + 1) / stacks;
+                           return Ring{radius * std::cos(phi), radius * std::sin(phi), glm::vec2(std::sin(phi), std::cos(phi)),
+                                       1.0f - float(k + 1) / stacks}; });
+}
+
+template <typename Index>
+void generateCapsule(float height, float radius, int slices, int hemisphereStacks, bool texCoords, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, capsuleSize(slices, hemisphereStacks, texCoords));
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+    float halfHeight = height / 2.0f, top = halfHeight + radius;
+    // rings 0..h-1 end at the upper equator, h..2h-1 start at the lower one
+    generateRevolution(out, top, -top, slices, 2 * hemisphereStacks, texCoords, [&](int k)
+                       {
+                           bool upper = k < hemisphereStacks;
+                           float phi = glm::half_pi<float>() * (upper ? k + 1 : k) / hemisphereStacks;
+                           float y = (upper ? halfHeight : -halfHeight) + radius * std::cos(phi);
+                           return Ring{y, radius * std::sin(phi), glm::vec2(std::sin(phi), std::cos(phi)), (y + top) / (2.0f * top)}; });
+}
+
+template <typename Index>
+void generateQuad(float width, float height, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, quadSize());
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+    glm::vec3 normal(0.0f, 0.0f, 1.0f);
+    Index first = out.vertex(glm::vec3(-width / 2.0f, -height / 2.0f, 0.0f), normal, glm::vec2(0.0f, 0.0f));
+    out.vertex(glm::vec3(width / 2.0f, -height / 2.0f, 0.0f), normal, glm::vec2(1.0f, 0.0f));
+    out.vertex(glm::vec3(width / 2.0f, height / 2.0f, 0.0f), normal, glm::vec2(1.0f, 1.0f));
+    out.vertex(glm::vec3(-width / 2.0f, height / 2.0f, 0.0f), normal, glm::vec2(0.0f, 1.0f));
+    out.triangle(first, first + 1, first + 2);
+    out.triangle(first, first + 2, first + 3);
+}
+
+template <typename Index>
+void generateBox(const glm::vec3 &halfExtents, Vertex *vertices, Index *indices, Index baseVertex)
+{
+    checkIndexRange(baseVertex, boxSize());
+    GeometryWriter<Index> out(vertices, indices, baseVertex);
+
+    // normal, then the face's u and v axes (u x v = normal)
+    static const glm::vec3 faces[6][3] = {
+        {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+        {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+        {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+    };
+    static const glm::vec2 corners[4] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    for (const auto &face : faces)
+    {
+        Index first = static_cast<Index>(baseVertex + out.vertexCount);
+        for (const glm::vec2 &corner : corners)
+            out.vertex((face[0] + face[1] * corner.x + face[2] * corner.y) * halfExtents, face[0], corner * 0.5f + glm::vec2(0.5f));
+        out.triangle(first, first + 1, first + 2);
+        out.triangle(first, first + 2, first + 3);
+    }
+}
+
+#define INSTANTIATE_GENERATORS(Index)                                                                                           \
+    template void generateCylinder<Index>(float, float, int, bool, Vertex *, Index *, Index);                                  \
+    template void generateCone<Index>(float, float, int, bool, Vertex *, Index *, Index);                                      \
+    template void generateSphere<Index>(float, int, int, bool, Vertex *, Index *, Index);                                      \
+    template void generateCapsule<Index>(float, float, int, int, bool, Vertex *, Index *, Index);                              \
+    template void generateQuad<Index>(float, float, Vertex *, Index *, Index);                                                 \
+    template void generateBox<Index>(const glm::vec3 &, Vertex *, Index *, Index);
+
+INSTANTIATE_GENERATORS(uint16_t)
+INSTANTIATE_GENERATORS(uint32_t)
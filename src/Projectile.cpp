@@ -0,0 +1,235 @@
+// Projectile.cpp
+#include "Projectile.h"
+#include "Procedural.h"
+#include "MeshOptimize.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PROJECTILE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PROJECTILE_SSE 1
+#endif
+
+// Cylinder dimensions shared by the geometry and the bounds
+static const float cylinderHeight = 1.0f;
+static const float cylinderRadius = 0.1f;
+static const int cylinderSegments = 36;
+
+static std::vector<Vertex> cylinderVertices()
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    generateCylinder(cylinderHeight, cylinderRadius, cylinderSegments, vertices, indices);
+    return vertices;
+}
+
+// Initialize static members
+MeshRange Projectile::geometry;
+BoundingBox Projectile::box = computeBoundingBox(cylinderVertices());
+BoundingSphere Projectile::bounds = computeBoundingSphere(cylinderVertices(), Projectile::box);
+
+void Projectile::initializeCylinder()
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    generateCylinder(cylinderHeight, cylinderRadius, cylinderSegments, vertices, indices);
+    optimizeMesh(vertices, indices);
+    geometry = meshArena.add(vertices, indices);
+}
+
+glm::mat4 Projectile::getOrientation(const glm::vec3 &velocity)
+{
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+
+    // Rotate to align with velocity
+    if (glm::length(velocity) > 0.0f)
+    {
+        glm::vec3 dir = glm::normalize(velocity);
+        float angle = glm::acos(glm::dot(dir, glm::vec3(0.0f, 1.0f, 0.0f)));
+        glm::vec3 axis = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), dir);
+        if (glm::length(axis) > 0.001f)
+            modelMatrix = glm::rotate(modelMatrix, angle, glm::normalize(axis));
+    }
+
+    return modelMatrix;
+}
+
+size_t integrateProjectiles(float *x, float *y, float *z, const float *vx, const float *vy, const float *vz, float *lifetime,
+                            size_t count, float deltaTime, float maxDistance, float maxLifetime, uint8_t *expired)
+{
+    // compare squared distances so no lane needs a square root
+    const float maxDistanceSquared = maxDistance * maxDistance;
+    size_t expiredCount = 0;
+
+    size_t i = 0;
+#if defined(PROJECTILE_AVX)
+    const __m256 dt8 = _mm256_set1_ps(deltaTime);
+    const __m256 maxDistance8 = _mm256_set1_ps(maxDistanceSquared);
+    const __m256 maxLifetime8 = _mm256_set1_ps(maxLifetime);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 px = _mm256_add_ps(_mm256_loadu_ps(&x[i]), _mm256_mul_ps(_mm256_loadu_ps(&vx[i]), dt8));
+        __m256 py = _mm256_add_ps(_mm256_loadu_ps(&y[i]), _mm256_mul_ps(_mm256_loadu_ps(&vy[i]), dt8));
+        __m256 pz = _mm256_add_ps(_mm256_loadu_ps(&z[i]), _mm256_mul_ps(_mm256_loadu_ps(&vz[i]), dt8));
+        __m256 age = _mm256_add_ps(_mm256_loadu_ps(&lifetime[i]), dt8);
+        _mm256_storeu_ps(&x[i], px);
+        _mm256_storeu_ps(&y[i], py);
+        _mm256_storeu_ps(&z[i], pz);
+        _mm256_storeu_ps(&lifetime[i], age);
+
+        __m256 distanceSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), _mm256_mul_ps(pz, pz));
+        __m256 out = _mm256_or_ps(_mm256_cmp_ps(distanceSquared, maxDistance8, _CMP_GT_OQ), _mm256_cmp_ps(age, maxLifetime8, _CMP_GT_OQ));
+        int mask = _mm256_movemask_ps(out);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            expired[i + lane] = (mask >> lane) & 1;
+            expiredCount += expired[i + lane];
+        }
+    }
+#elif defined(PROJECTILE_SSE)
+    const __m128 dt4 = _mm_set1_ps(deltaTime);
+    const __m128 maxDistance4 = _mm_set1_ps(maxDistanceSquared);
+    const __m128 maxLifetime4 = _mm_set1_ps(maxLifetime);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(_mm_loadu_ps(&vx[i]), dt4));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(_mm_loadu_ps(&vy[i]), dt4));
+        __m128 pz = _mm_add_ps(_mm_loadu_ps(&z[i]), _mm_mul_ps(_mm_loadu_ps(&vz[i]), dt4));
+        __m128 age = _mm_add_ps(_mm_loadu_ps(&lifetime[i]), dt4);
+        _mm_storeu_ps(&x[i], px);
+        _mm_storeu_ps(&y[i], py);
+        _mm_storeu_ps(&z[i], pz);
+        _mm_storeu_ps(&lifetime[i], age);
+
+        __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz));
+        __m128 out = _mm_or_ps(_mm_cmpgt_ps(distanceSquared, maxDistance4), _mm_cmpgt_ps(age, maxLifetime4));
+        int mask = _mm_movemask_ps(out);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            expired[i + lane] = (mask >> lane) & 1;
+            expiredCount += expired[i + lane];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+        z[i] += vz[i] * deltaTime;
+        lifetime[i] += deltaTime;
+        float distanceSquared = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        expired[i] = (distanceSquared > maxDistanceSquared || lifetime[i] > maxLifetime) ? 1 : 0;
+        expiredCount += expired[i];
+    }
+    return expiredCount;
+}
+
+void ProjectileList::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    vx.clear();
+    vy.clear();
+    vz.clear();
+    lifetime.clear();
+    previousX.clear();
+    previousY.clear();
+    previousZ.clear();
+    extents.clear();
+}
+
+void ProjectileList::add(const glm::vec3 &position, const glm::vec3 &velocity)
+{
+    x.push_back(position.x);
+    y.push_back(position.y);
+    z.push_back(position.z);
+    vx.push_back(velocity.x);
+    vy.push_back(velocity.y);
+    vz.push_back(velocity.z);
+    lifetime.push_back(0.0f);
+    previousX.push_back(position.x);
+    previousY.push_back(position.y);
+    previousZ.push_back(position.z);
+    // the velocity never changes, so neither does the box around the rotated cylinder
+    extents.push_back(transformBox(Projectile::box, Projectile::getOrientation(velocity)));
+}
+
+void ProjectileList::remove(size_t index)
+{
+    x.erase(x.begin() + index);
+    y.erase(y.begin() + index);
+    z.erase(z.begin() + index);
+    vx.erase(vx.begin() + index);
+    vy.erase(vy.begin() + index);
+    vz.erase(vz.begin() + index);
+    lifetime.erase(lifetime.begin() + index);
+    previousX.erase(previousX.begin() + index);
+    previousY.erase(previousY.begin() + index);
+    previousZ.erase(previousZ.begin() + index);
+    extents.erase(extents.begin() + index);
+}
+
+void ProjectileList::update(float deltaTime)
+{
+    size_t count = size();
+    previousX = x;
+    previousY = y;
+    previousZ = z;
+    expired.resize(count);
+    if (integrateProjectiles(x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), lifetime.data(), count, deltaTime,
+                             Projectile::maxDistance, Projectile::maxLifetime, expired.data()) == 0)
+        return;
+
+    // compact the survivors in place, keeping their order
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (expired[i])
+            continue;
+        x[kept] = x[i];
+        y[kept] = y[i];
+        z[kept] = z[i];
+        vx[kept] = vx[i];
+        vy[kept] = vy[i];
+        vz[kept] = vz[i];
+        lifetime[kept] = lifetime[i];
+        previousX[kept] = previousX[i];
+        previousY[kept] = previousY[i];
+        previousZ[kept] = previousZ[i];
+        extents[kept] = extents[i];
+        kept++;
+    }
+    x.resize(kept);
+    y.resize(kept);
+    z.resize(kept);
+    vx.resize(kept);
+    vy.resize(kept);
+    vz.resize(kept);
+    lifetime.resize(kept);
+    previousX.resize(kept);
+    previousY.resize(kept);
+    previousZ.resize(kept);
+    extents.resize(kept);
+}
+
+glm::mat4 ProjectileList::getModelMatrix(size_t index, float alpha) const
+{
+    return glm::translate(glm::mat4(1.0f), getInterpolatedPosition(index, alpha)) * Projectile::getOrientation(getVelocity(index));
+}
+
+void ProjectileList::Draw(size_t index, Shader &shader, float alpha) const
+{
+    const MeshRange &geometry = Projectile::geometry;
+    glState.useProgram(shader.ID);
+    shader.setMat4("model", getModelMatrix(index, alpha));
+
+    glState.bindVertexArray(meshArena.VAO);
+    glState.drawElementsBaseVertex(GL_TRIANGLES, geometry.indexCount, geometry.indexType, geometry.indexOffset(), geometry.baseVertex);
+}
+
+void ProjectileList::Submit(size_t index, RenderQueue &queue, Shader &shader, const glm::vec3 &materialColor, const glm::vec3 &emissionColor, float alpha) const
+{
+    queue.submit(shader, meshArena.VAO, Projectile::geometry, materialColor, emissionColor, getModelMatrix(index, alpha));
+}
@@ -0,0 +1,314 @@
+#include "RenderQueue.h"
+#include "Mesh.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+// Instances per job when filling the mapped instance buffer
+static const size_t INSTANCE_BATCH = 4096;
+
+// 16 bits of shader, 24 of material, 24 of VAO
+static uint64_t makeSortKey(unsigned int shader, unsigned int material, unsigned int VAO)
+{
+    return (static_cast<uint64_t>(shader & 0xFFFF) << 48) |
+           (static_cast<uint64_t>(material & 0xFFFFFF) << 24) |
+           static_cast<uint64_t>(VAO & 0xFFFFFF);
+}
+
+// Flat colours share a material when they are equal at 8 bits per channel
+static unsigned int colorKey(const glm::vec3 &color)
+{
+    auto channel = [](float v)
+    { return static_cast<unsigned int>(std::min(std::max(v, 0.0f), 1.0f) * 255.0f); };
+    return (channel(color.x) << 16) | (channel(color.y) << 8) | channel(color.z);
+}
+
+// Materials match when they bind the same textures (each model instance has its own copy of the list)
+static bool sameTextures(const std::vector<Texture> *a, const std::vector<Texture> *b)
+{
+    if (a == b)
+        return true;
+    if (!a || !b || a->size() != b->size())
+        return false;
+    for (size_t i = 0; i < a->size(); i++)
+    {
+        if ((*a)[i].id != (*b)[i].id || (*a)[i].type != (*b)[i].type)
+            return false;
+    }
+    return true;
+}
+
+void RenderQueue::submit(Shader &shader, unsigned int VAO, const MeshRange &range, const std::vector<Texture> &textures, const glm::mat4 &model)
+{
+    unsigned int material = textures.empty() ? 0 : textures[0].id;
+    items.push_back({&shader, VAO, range, &textures, glm::vec3(0.0f), glm::vec3(0.0f), model,
+                     makeSortKey(shader.ID, material, VAO), NO_INSTANCE_RUN});
+}
+
+void RenderQueue::submit(Shader &shader, unsigned int VAO, const MeshRange &range, const glm::vec3 &materialColor, const glm::vec3 &emissionColor, const glm::mat4 &model)
+{
+    items.push_back({&shader, VAO, range, nullptr, materialColor, emissionColor, model,
+                     makeSortKey(shader.ID, colorKey(materialColor), VAO), NO_INSTANCE_RUN});
+}
+
+void RenderQueue::submitInstances(Shader &shader, unsigned int VAO, const MeshRange &range, const std::vector<Texture> &textures, size_t count, InstanceFill fill)
+{
+    if (count == 0)
+        return;
+    unsigned int material = textures.empty() ? 0 : textures[0].id;
+    items.push_back({&shader, VAO, range, &textures, glm::vec3(0.0f), glm::vec3(0.0f), glm::mat4(1.0f),
+                     makeSortKey(shader.ID, material, VAO), runs.size()});
+    runs.push_back({count, std::move(fill), 0});
+}
+
+size_t RenderQueue::placeRuns(size_t first)
+{
+    for (InstanceRun &run : runs)
+    {
+        run.first = first;
+        first += run.count;
+    }
+    return first;
+}
+
+void RenderQueue::fillRuns(InstanceData *out)
+{
+    for (const InstanceRun &run : runs)
+    {
+        InstanceData *base = out + run.first;
+        if (run.count > INSTANCE_BATCH)
+            jobSystem.parallelFor(run.count, INSTANCE_BATCH, [&](size_t begin, size_t end)
+                                  { run.fill(base, begin, end); });
+        else
+            run.fill(base, 0, run.count);
+    }
+}
+
+void RenderQueue::flush(GLStateCache &state)
+{
+    std::sort(items.begin(), items.end(), [](const DrawItem &a, const DrawItem &b)
+              {
+                  if (a.sortKey != b.sortKey)
+                      return a.sortKey < b.sortKey;
+                  if (a.range.indexType != b.range.indexType)
+                      return a.range.indexType < b.range.indexType;
+                  return a.range.firstIndex < b.range.firstIndex; });
+
+    for (const DrawItem &item : items)
+        state.frame.triangles += item.range.indexCount / 3 * (item.run == NO_INSTANCE_RUN ? 1 : runs[item.run].count);
+
+    // the instance attributes only exist on the arena VAOs
+    bool arenaOnly = std::all_of(items.begin(), items.end(), [](const DrawItem &item)
+                                 { return item.VAO == meshArena.VAO || item.VAO == packedMeshArena.VAO; });
+    if (indirect && arenaOnly && !items.empty())
+        flushIndirect(state);
+    else
+        flushDirect(state);
+
+    items.clear();
+    runs.clear();
+}
+
+void RenderQueue::flushDirect(GLStateCache &state)
+{
+    instances.resize(placeRuns(0));
+    fillRuns(instances.data());
+
+    const Shader *shader = nullptr;
+    const std::vector<Texture> *textures = nullptr;
+    bool colorSet = false;
+    glm::vec3 materialColor, emissionColor;
+
+    for (const DrawItem &item : items)
+    {
+        if (item.shader != shader)
+        {
+            state.useProgram(item.shader->ID);
+            item.shader->setBool("instanced", false);
+            shader = item.shader;
+            textures = nullptr;
+            colorSet = false;
+        }
+
+        // material: sampler uniforms and texture binds, or the flat colours
+        if (item.textures)
+        {
+            if (!sameTextures(item.textures, textures))
+            {
+                bindMaterialTextures(*item.shader, *item.textures, state);
+                textures = item.textures;
+            }
+        }
+        else if (!colorSet || item.materialColor != materialColor || item.emissionColor != emissionColor)
+        {
+            item.shader->setVec3("materialColor", item.materialColor);
+            item.shader->setVec3("emissionColor", item.emissionColor);
+            materialColor = item.materialColor;
+            emissionColor = item.emissionColor;
+            colorSet = true;
+        }
+
+        state.bindVertexArray(item.VAO);
+        if (item.run == NO_INSTANCE_RUN)
+        {
+            item.shader->setMat4("model", item.model);
+            state.drawElementsBaseVertex(GL_TRIANGLES, item.range.indexCount, item.range.indexType,
+                                         item.range.indexOffset(), item.range.baseVertex);
+            continue;
+        }
+        const InstanceRun &run = runs[item.run];
+        for (size_t i = run.first; i < run.first + run.count; i++)
+        {
+            item.shader->setMat4("model", instances[i].model);
+            state.drawElementsBaseVertex(GL_TRIANGLES, item.range.indexCount, item.range.indexType,
+                                         item.range.indexOffset(), item.range.baseVertex);
+        }
+    }
+}
+
+void RenderQueue::flushIndirect(GLStateCache &state)
+{
+    commands.clear();
+    batches.clear();
+
+    // one batch per shader + material + arena + index type run; consecutive draws of the same mesh share a command
+    // (instance i is items[i], written straight into the instance buffer below, and the instance runs follow them)
+    size_t instanceCount = placeRuns(items.size());
+    for (const DrawItem &item : items)
+    {
+        bool sameBatch = !batches.empty() && batches.back().shader == item.shader && batches.back().VAO == item.VAO &&
+                         batches.back().indexType == item.range.indexType && sameTextures(batches.back().textures, item.textures);
+        if (!sameBatch)
+            batches.push_back({item.shader, item.textures, item.VAO, item.range.indexType, commands.size(), 0});
+
+        size_t index = &item - items.data();
+        if (item.run != NO_INSTANCE_RUN)
+        {
+            const InstanceRun &run = runs[item.run];
+            commands.push_back({item.range.indexCount, static_cast<GLuint>(run.count), item.range.firstIndex, item.range.baseVertex,
+                                static_cast<GLuint>(run.first)});
+            batches.back().commandCount++;
+            continue;
+        }
+
+        DrawElementsIndirectCommand *last = commands.empty() ? nullptr : &commands.back();
+        if (sameBatch && last->firstIndex == item.range.firstIndex && last->baseVertex == item.range.baseVertex &&
+            last->baseInstance + last->instanceCount == index)
+        {
+            last->instanceCount++;
+        }
+        else
+        {
+            commands.push_back({item.range.indexCount, 1, item.range.firstIndex, item.range.baseVertex,
+                                static_cast<GLuint>(index)});
+            batches.back().commandCount++;
+        }
+    }
+
+    // map the instance buffer invalidated, so the GPU can keep reading last frame's copy,
+    // and fill it in parallel batches
+    for (const Batch &batch : batches)
+        setupInstanceAttributes(state, batch.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceCount > instanceCapacity)
+    {
+        instanceCapacity = std::max(instanceCount, instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    }
+    InstanceData *mapped = static_cast<InstanceData *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(InstanceData),
+                                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    auto writeInstances = [&](InstanceData *out, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            out[i] = {items[i].model, items[i].materialColor, items[i].emissionColor};
+    };
+    if (mapped)
+    {
+        if (items.size() > INSTANCE_BATCH)
+            jobSystem.parallelFor(items.size(), INSTANCE_BATCH, [&](size_t begin, size_t end)
+                                  { writeInstances(mapped, begin, end); });
+        else
+            writeInstances(mapped, 0, items.size());
+        fillRuns(mapped);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    else
+    {
+        // mapping failed: stage the instances and copy them in
+        instances.resize(instanceCount);
+        writeInstances(instances.data(), 0, items.size());
+        fillRuns(instances.data());
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+
+    if (commands.size() > commandCapacity)
+        commandCapacity = std::max(commands.size(), commandCapacity * 2);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commandCapacity * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+
+    const Shader *shader = nullptr;
+    for (const Batch &batch : batches)
+    {
+        state.bindVertexArray(batch.VAO);
+        if (batch.shader != shader)
+        {
+            state.useProgram(batch.shader->ID);
+            batch.shader->setBool("instanced", true);
+            shader = batch.shader;
+        }
+        if (batch.textures)
+            bindMaterialTextures(*batch.shader, *batch.textures, state);
+
+        state.multiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                                        (void *)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(batch.commandCount));
+    }
+}
+
+// Point attributes 3-8 of VAO at the instance buffer (once per VAO; the buffer name never changes)
+void RenderQueue::setupInstanceAttributes(GLStateCache &state, unsigned int VAO)
+{
+    if (instanceVBO == 0)
+    {
+        glGenBuffers(1, &instanceVBO);
+        glGenBuffers(1, &indirectBuffer);
+
+        // the attributes stay enabled for the per-draw path too, so never leave the buffer empty
+        instanceCapacity = 256;
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    }
+    if (std::find(instanceVAOs.begin(), instanceVAOs.end(), VAO) != instanceVAOs.end())
+        return;
+
+    state.bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void *)(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void *)offsetof(InstanceData, materialColor));
+    glVertexAttribDivisor(7, 1);
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void *)offsetof(InstanceData, emissionColor));
+    glVertexAttribDivisor(8, 1);
+    instanceVAOs.push_back(VAO);
+}
+
+void RenderQueue::destroy()
+{
+    if (instanceVBO != 0)
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        glDeleteBuffers(1, &indirectBuffer);
+        instanceVBO = indirectBuffer = 0;
+    }
+    instanceVAOs.clear();
+    instanceCapacity = commandCapacity = 0;
+}
@@ -0,0 +1,315 @@
+#include "Simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+// border edges are held in place by a plane perpendicular to their triangle, weighted this much more
+static const double BORDER_WEIGHT = 10.0;
+
+// each pass collapses a set of independent edges; the mesh usually reaches its target well before this
+static const int MAX_PASSES = 64;
+
+// Symmetric 4x4 error matrix of a sum of planes (upper triangle stored),
+// plus the total area of the planes so errors come out as squared distances
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    void addPlane(const glm::vec3 &n, float d, double w)
+    {
+        a00 += w * n.x * n.x;
+        a01 += w * n.x * n.y;
+        a02 += w * n.x * n.z;
+        a03 += w * n.x * d;
+        a11 += w * n.y * n.y;
+        a12 += w * n.y * n.z;
+        a13 += w * n.y * d;
+        a22 += w * n.z * n.z;
+        a23 += w * n.z * d;
+        a33 += w * d * d;
+    }
+
+    void add(const Quadric &q)
+    {
+        a00 += q.a00;
+        a01 += q.a01;
+        a02 += q.a02;
+        a03 += q.a03;
+        a11 += q.a11;
+        a12 += q.a12;
+        a13 += q.a13;
+        a22 += q.a22;
+        a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+    }
+
+    // mean squared distance of p to the planes
+    double error(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                   a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+                   a22 * z * z + 2 * a23 * z +
+                   a33;
+        return std::max(e, 0.0) / std::max(weight, 1e-12);
+    }
+};
+
+struct PositionHash
+{
+    size_t operator()(const glm::vec3 &p) const
+    {
+        uint32_t bits[3];
+        std::memcpy(bits, &p.x, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+struct PositionEqual
+{
+    bool operator()(const glm::vec3 &a, const glm::vec3 &b) const
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+};
+
+static glm::vec3 triangleNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    return glm::cross(b - a, c - a);
+}
+
+static uint64_t edgeKey(unsigned int a, unsigned int b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+// Of the vertices sharing a position, the one whose normal and UV are closest to those of vertex 'from'
+static unsigned int closestVertex(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &members, unsigned int from)
+{
+    unsigned int best = members[0];
+    float bestDistance = std::numeric_limits<float>::max();
+    for (unsigned int candidate : members)
+    {
+        glm::vec3 dn = vertices[candidate].Normal - vertices[from].Normal;
+        glm::vec2 dt = vertices[candidate].TexCoords - vertices[from].TexCoords;
+        float distance = glm::dot(dn, dn) + glm::dot(dt, dt);
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+std::vector<unsigned int> simplifyMesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                                       size_t targetIndexCount, float *error)
+{
+    std::vector<unsigned int> result = indices;
+    if (error)
+        *error = 0.0f;
+    if (result.size() <= targetIndexCount)
+        return result;
+
+    // weld: one "position" per distinct vertex position, with the vertices that share it
+    std::vector<unsigned int> positionOf(vertices.size());
+    std::vector<glm::vec3> positions;
+    std::vector<std::vector<unsigned int>> members;
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionHash, PositionEqual> lookup;
+        for (unsigned int i = 0; i < vertices.size(); i++)
+        {
+            auto inserted = lookup.emplace(vertices[i].Position, static_cast<unsigned int>(positions.size()));
+            if (inserted.second)
+            {
+                positions.push_back(vertices[i].Position);
+                members.emplace_back();
+            }
+            positionOf[i] = inserted.first->second;
+            members[inserted.first->second].push_back(i);
+        }
+    }
+    size_t positionCount = positions.size();
+
+    // error quadrics: the planes of the triangles around each position, and of the borders
+    std::vector<Quadric> quadrics(positionCount);
+    std::unordered_map<uint64_t, int> edgeUse;
+    for (size_t t = 0; t + 2 < result.size(); t += 3)
+    {
+        unsigned int p[3] = {positionOf[result[t]], positionOf[result[t + 1]], positionOf[result[t + 2]]};
+        glm::vec3 n = triangleNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+        float length = glm::length(n);
+        if (length == 0.0f)
+            continue;
+        n /= length;
+        float d = -glm::dot(n, positions[p[0]]);
+        double area = 0.5 * length;
+        for (int k = 0; k < 3; k++)
+        {
+            quadrics[p[k]].addPlane(n, d, area);
+            quadrics[p[k]].weight += area;
+            edgeUse[edgeKey(p[k], p[(k + 1) % 3])]++;
+        }
+    }
+    for (size_t t = 0; t + 2 < result.size(); t += 3)
+    {
+        unsigned int p[3] = {positionOf[result[t]], positionOf[result[t + 1]], positionOf[result[t + 2]]};
+        glm::vec3 n = triangleNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+        if (glm::length(n) == 0.0f)
+            continue;
+        n = glm::normalize(n);
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int a = p[k], b = p[(k + 1) % 3];
+            if (edgeUse[edgeKey(a, b)] != 1)
+                continue;
+            glm::vec3 edge = positions[b] - positions[a];
+            glm::vec3 side = glm::cross(edge, n);
+            float length = glm::length(side);
+            if (length == 0.0f)
+                continue;
+            side /= length;
+            float d = -glm::dot(side, positions[a]);
+            double w = BORDER_WEIGHT * glm::dot(edge, edge);
+            quadrics[a].addPlane(side, d, w);
+            quadrics[b].addPlane(side, d, w);
+        }
+    }
+
+    struct Collapse
+    {
+        unsigned int from, to;
+        double cost;
+    };
+
+    std::vector<unsigned int> collapseTo(positionCount);
+    std::vector<unsigned char> locked(positionCount);
+    std::vector<unsigned int> adjacencyStart(positionCount + 1), adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    double maxError = 0.0;
+    size_t targetTriangles = targetIndexCount / 3;
+
+    for (int pass = 0; pass < MAX_PASSES && result.size() / 3 > targetTriangles; pass++)
+    {
+        size_t triangleCount = result.size() / 3;
+
+        // unique edges and the triangles around each position
+        edges.clear();
+        std::fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int a = positionOf[result[t * 3 + k]], b = positionOf[result[t * 3 + (k + 1) % 3]];
+                edges.push_back(edgeKey(a, b));
+                adjacencyStart[a + 1]++;
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        for (size_t i = 0; i < positionCount; i++)
+            adjacencyStart[i + 1] += adjacencyStart[i];
+        adjacency.assign(adjacencyStart[positionCount], 0);
+        {
+            std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+            for (size_t t = 0; t < triangleCount; t++)
+                for (int k = 0; k < 3; k++)
+                    adjacency[fill[positionOf[result[t * 3 + k]]]++] = static_cast<unsigned int>(t);
+        }
+
+        // cheapest direction of every edge, cheapest edges first
+        collapses.clear();
+        for (uint64_t key : edges)
+        {
+            unsigned int a = static_cast<unsigned int>(key >> 32), b = static_cast<unsigned int>(key);
+            Quadric q = quadrics[a];
+            q.add(quadrics[b]);
+            double toB = q.error(positions[b]), toA = q.error(positions[a]);
+            collapses.push_back(toB <= toA ? Collapse{a, b, toB} : Collapse{b, a, toA});
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y)
+                  { return x.cost < y.cost; });
+
+        // collapse independent edges until enough triangles are gone
+        for (size_t i = 0; i < positionCount; i++)
+            collapseTo[i] = static_cast<unsigned int>(i);
+        std::fill(locked.begin(), locked.end(), 0);
+        size_t removeGoal = triangleCount - targetTriangles, removed = 0, collapsed = 0;
+        for (const Collapse &c : collapses)
+        {
+            if (removed >= removeGoal)
+                break;
+            if (locked[c.from] || locked[c.to])
+                continue;
+
+            // reject collapses that flip a triangle or touch one already changed in this pass
+            bool valid = true;
+            size_t vanishing = 0;
+            for (unsigned int i = adjacencyStart[c.from]; i < adjacencyStart[c.from + 1] && valid; i++)
+            {
+                unsigned int p[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    p[k] = positionOf[result[adjacency[i] * 3 + k]];
+                    valid = valid && collapseTo[p[k]] == p[k];
+                }
+                if (p[0] == c.to || p[1] == c.to || p[2] == c.to)
+                {
+                    vanishing++;
+                    continue;
+                }
+                glm::vec3 before = triangleNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+                glm::vec3 moved[3];
+                for (int k = 0; k < 3; k++)
+                    moved[k] = positions[p[k] == c.from ? c.to : p[k]];
+                glm::vec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+                valid = valid && glm::dot(before, after) > 0.0f;
+            }
+            if (!valid)
+                continue;
+
+            collapseTo[c.from] = c.to;
+            quadrics[c.to].add(quadrics[c.from]);
+            maxError = std::max(maxError, c.cost);
+            for (unsigned int i = adjacencyStart[c.from]; i < adjacencyStart[c.from + 1]; i++)
+                for (int k = 0; k < 3; k++)
+                    locked[positionOf[result[adjacency[i] * 3 + k]]] = 1;
+            removed += vanishing;
+            collapsed++;
+        }
+        if (collapsed == 0)
+            break;
+
+        // move the collapsed corners and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            unsigned int corner[3];
+            for (int k = 0; k < 3; k++)
+            {
+                corner[k] = result[t * 3 + k];
+                unsigned int target = collapseTo[positionOf[corner[k]]];
+                if (target != positionOf[corner[k]])
+                    corner[k] = closestVertex(vertices, members[target], corner[k]);
+            }
+            unsigned int p0 = positionOf[corner[0]], p1 = positionOf[corner[1]], p2 = positionOf[corner[2]];
+            if (p0 == p1 || p1 == p2 || p0 == p2)
+                continue;
+            for (int k = 0; k < 3; k++)
+                result[write++] = corner[k];
+        }
+        result.resize(write);
+    }
+
+    if (error)
+        *error = static_cast<float>(std::sqrt(maxError));
+    return result;
+}
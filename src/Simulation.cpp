@@ -0,0 +1,251 @@
+#include "Simulation.h"
+
+void Simulation::reset(std::vector<glm::vec3> enemySlots)
+{
+    formation.reset(std::move(enemySlots));
+    enemyDirection = 1;
+    enemyShootTimer = 0.0f;
+
+    fighterPosition = fighterStart;
+    fighterPrevious = fighterStart;
+    fighterVelocity = 0.0f;
+    fighterTilt = 0.0f;
+    fighterPreviousTilt = 0.0f;
+    fighterShootTimer = 0.0f;
+    fireHeld = false;
+    projectiles.clear();
+    enemyProjectiles.clear();
+
+    score = 0;
+    playerLives = 3;
+    gameOver = false;
+}
+
+void Simulation::updateFighter(float deltaTime, const FighterInput &input, SimulationEvents &events)
+{
+    fighterPrevious = fighterPosition;
+    fighterPreviousTilt = fighterTilt;
+
+    // Shoot on a fresh press once the cooldown is over
+    if (fighterShootTimer > 0.0f)
+        fighterShootTimer -= deltaTime;
+
+    if (input.fire)
+    {
+        if (!fireHeld && fighterShootTimer <= 0.0f)
+        {
+            fireHeld = true;
+
+            // straight ahead (+x), from just in front of the fighter
+            glm::vec3 forward = glm::vec3(1.0f, 0.0f, 0.0f);
+            projectiles.add(fighterPosition + forward * 1.0f, forward * 50.0f);
+
+            fighterShootTimer = fighterShootCooldown;
+            events.shotsFired++;
+        }
+    }
+    else
+    {
+        fireHeld = false;
+    }
+
+    // The fighter only moves with the camera at one of the predefined positions
+    if (input.cameraPreset < 1 || input.cameraPreset > 3)
+        return;
+
+    float targetTilt = 0.0f;
+    bool isMoving = false;
+    bool atBoundary = false;
+
+    // Accelerate with a key held, else slow down to a stop
+    if (input.left)
+    {
+        isMoving = true;
+        targetTilt = -fighterMaxTilt;
+        fighterVelocity -= fighterAcceleration * deltaTime;
+    }
+    else if (input.right)
+    {
+        isMoving = true;
+        targetTilt = fighterMaxTilt;
+        fighterVelocity += fighterAcceleration * deltaTime;
+    }
+    else if (fighterVelocity > 0.0f)
+    {
+        fighterVelocity = std::max(fighterVelocity - fighterDamping * deltaTime, 0.0f);
+    }
+    else if (fighterVelocity < 0.0f)
+    {
+        fighterVelocity = std::min(fighterVelocity + fighterDamping * deltaTime, 0.0f);
+    }
+    fighterVelocity = glm::clamp(fighterVelocity, -fighterMaxSpeed, fighterMaxSpeed);
+
+    // Move, stopping at the bounds of the camera preset
+    fighterPosition.z += fighterVelocity * deltaTime;
+    float minZ = fighterMinZ[input.cameraPreset - 1];
+    float maxZ = fighterMaxZ[input.cameraPreset - 1];
+    if (fighterPosition.z < minZ)
+    {
+        fighterPosition.z = minZ;
+        fighterVelocity = 0.0f;
+        atBoundary = true;
+    }
+    if (fighterPosition.z > maxZ)
+    {
+        fighterPosition.z = maxZ;
+        fighterVelocity = 0.0f;
+        atBoundary = true;
+    }
+
+    // Ease the tilt towards the direction of travel, or level unless held against a bound
+    if (isMoving)
+        fighterTilt = glm::mix(fighterTilt, targetTilt, fighterTiltSpeed * deltaTime);
+    else if (!atBoundary)
+        fighterTilt = glm::mix(fighterTilt, 0.0f, fighterTiltSpeed * deltaTime);
+}
+
+SimulationEvents Simulation::tick(float deltaTime, const FighterInput &input)
+{
+    SimulationEvents events;
+    updateFighter(deltaTime, input, events);
+    formation.previousOffset = formation.offset;
+
+    // Enemy group movement for this tick: slide sideways, or turn and move down at a boundary
+    float deltaZ = enemyDirection * enemyMoveSpeed * deltaTime;
+    bool boundaryReached = (enemyDirection == 1 && formation.offset.z + formation.slotMax().z + deltaZ > enemyBoundaryRight) ||
+                           (enemyDirection == -1 && formation.offset.z + formation.slotMin().z + deltaZ < enemyBoundaryLeft);
+    glm::vec3 enemyStep = boundaryReached ? glm::vec3(-enemyMoveDownDistance, 0.0f, 0.0f) : glm::vec3(0.0f, 0.0f, deltaZ);
+
+    // Check collisions: each enemy against the whole move of every player bolt this tick
+    // (relative to the enemies, so fast bolts cannot tunnel through), OVERLAP_BATCH at a time
+    boltBoxes.clear();
+    for (size_t p = 0; p < projectiles.size(); p++)
+    {
+        boltBoxes.add(projectiles.getBoundingBoxMin(p), projectiles.getBoundingBoxMax(p), projectiles.getVelocity(p) * deltaTime - enemyStep);
+    }
+    bool invaderLanded = false;
+    formation.forEachAlive([&](size_t slot)
+                           {
+        glm::vec3 enemyPos = formation.getPosition(slot);
+        glm::vec3 enemyMin = enemyPos + enemyBox.min;
+        glm::vec3 enemyMax = enemyPos + enemyBox.max;
+
+        for (size_t first = 0; first < boltBoxes.size(); first += OVERLAP_BATCH)
+        {
+            uint32_t mask = sweptOverlapMask(enemyMin, enemyMax, boltBoxes, first);
+            if (mask != 0)
+            {
+                // Remove the earliest projectile that hit, and the enemy
+                size_t p = first + lowestBit(mask);
+                projectiles.remove(p);
+                boltBoxes.remove(p);
+                formation.kill(slot);
+
+                // Increment score
+                score += 100; // Assign points per enemy, adjust as needed
+                events.enemiesDestroyed++;
+                events.destroyedAt.push_back(enemyPos);
+                return; // Stop checking other projectiles for this enemy
+            }
+        }
+
+        // Check if this invader has reached the losing position
+        if (enemyPos.x <= 12.5f)
+            invaderLanded = true; });
+    if (invaderLanded)
+    {
+        std::cout << "An invader reached the player! Game Over!" << std::endl;
+        gameOver = true;
+    }
+
+    // Update player projectiles, dropping the ones that expired
+    projectiles.update(deltaTime);
+
+    // Move the whole formation, turning it at a boundary
+    if (boundaryReached)
+    {
+        enemyDirection *= -1;
+    }
+    formation.offset += enemyStep;
+
+    // Enemy shooting logic
+    if (enemyShootTimer > 0.0f)
+        enemyShootTimer -= deltaTime;
+
+    if (enemyShootTimer <= 0.0f)
+    {
+        // Randomly pick an enemy to shoot
+        if (!formation.empty())
+        {
+            uint32_t randomEnemyIndex = enemyFireRandom.below(static_cast<uint32_t>(formation.aliveCount()));
+            glm::vec3 enemyPos = formation.getPosition(formation.nthAlive(randomEnemyIndex));
+
+            glm::vec3 playerLineDirection = glm::normalize(glm::vec3(1.0f, 0.0f, 0.0f)); // Replace this with player's movement direction
+
+            // Create the enemy projectile
+            glm::vec3 projectileVelocity = -playerLineDirection * 20.0f; // Negative for opposite direction
+            enemyProjectiles.add(enemyPos, projectileVelocity);
+        }
+
+        // Reset the timer
+        enemyShootTimer = enemyShootCooldown;
+    }
+
+    // Check collisions between player and enemy projectiles, over each projectile's move this tick
+    glm::vec3 playerMin = fighterPosition + fighterBox.min;
+    glm::vec3 playerMax = fighterPosition + fighterBox.max;
+    boltBoxes.clear();
+    for (size_t p = 0; p < enemyProjectiles.size(); p++)
+    {
+        boltBoxes.add(enemyProjectiles.getBoundingBoxMin(p), enemyProjectiles.getBoundingBoxMax(p), enemyProjectiles.getVelocity(p) * deltaTime);
+    }
+    std::vector<size_t> hits;
+    for (size_t first = 0; first < boltBoxes.size(); first += OVERLAP_BATCH)
+    {
+        for (uint32_t mask = sweptOverlapMask(playerMin, playerMax, boltBoxes, first); mask != 0; mask &= mask - 1)
+        {
+            hits.push_back(first + lowestBit(mask));
+
+            // Player is hit
+            playerLives--;
+            events.playerHits++;
+            std::cout << "Player hit! Lives remaining: " << playerLives << std::endl;
+
+            // Check if the game should end
+            if (playerLives <= 0)
+            {
+                std::cout << "Game Over! Player ran out of lives." << std::endl;
+                gameOver = true; // Set the game over flag
+            }
+        }
+    }
+
+    // Remove the projectiles that hit, last first so the indices stay valid
+    for (auto it = hits.rbegin(); it != hits.rend(); ++it)
+    {
+        enemyProjectiles.remove(*it);
+    }
+
+    // Update enemy projectiles, dropping the ones that expired
+    enemyProjectiles.update(deltaTime);
+
+    return events;
+}
+
+void Simulation::takeSnapshot(SimulationSnapshot &snapshot) const
+{
+    snapshot.fighterPrevious = fighterPrevious;
+    snapshot.fighterPosition = fighterPosition;
+    snapshot.fighterPreviousTilt = fighterPreviousTilt;
+    snapshot.fighterTilt = fighterTilt;
+    snapshot.enemyPrevious.clear();
+    snapshot.enemyPositions.clear();
+    formation.forEachAlive([&](size_t slot)
+                           {
+        snapshot.enemyPrevious.push_back(formation.getPreviousPosition(slot));
+        snapshot.enemyPositions.push_back(formation.getPosition(slot)); });
+    snapshot.projectiles = projectiles;
+    snapshot.enemyProjectiles = enemyProjectiles;
+    snapshot.score = score;
+    snapshot.playerLives = playerLives;
+}
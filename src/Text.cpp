@@ -0,0 +1,150 @@
+#include "Text.h"
+#include "GLState.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+unsigned int textVAO, textVBO;        // VAO and VBO for text rendering
+std::map<char, Character> Characters; // Stores characters with their OpenGL textures
+
+void initTextRendering(const std::string &fontPath)
+{
+    // 1. Inicializa FreeType
+    FT_Library ft;
+    if (FT_Init_FreeType(&ft))
+    {
+        std::cerr << "ERRO: Não foi possível inicializar FreeType\n";
+        return;
+    }
+
+    // 2. Carrega a fonte
+    FT_Face face;
+    if (FT_New_Face(ft, fontPath.c_str(), 0, &face))
+    {
+        std::cerr << "ERRO: Falha ao carregar a fonte: " << fontPath << std::endl;
+        FT_Done_FreeType(ft);
+        return;
+    }
+
+    // Define o tamanho que queremos em pixels (altura = 48)
+    FT_Set_Pixel_Sizes(face, 0, 48);
+
+    // Informa ao OpenGL que o alinhamento é de 1 byte
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // 3. Para cada caractere ASCII imprimível, gera um glifo
+    for (unsigned char c = 0; c < 128; c++)
+    {
+        // Carrega o glifo
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        {
+            std::cerr << "ERRO: Falha ao carregar glifo: " << (int)c << std::endl;
+            continue;
+        }
+        // Cria textura em OpenGL
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glState.bindTexture(0, GL_TEXTURE_2D, texture);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RED,
+            face->glyph->bitmap.width,
+            face->glyph->bitmap.rows,
+            0,
+            GL_RED,
+            GL_UNSIGNED_BYTE,
+            face->glyph->bitmap.buffer);
+
+        // Configura parâmetros da textura
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Armazena o caractere no map
+        Character character = {
+            texture,
+            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
+            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
+            static_cast<unsigned int>(face->glyph->advance.x)};
+        Characters.insert(std::pair<char, Character>(c, character));
+    }
+    glState.bindTexture(0, GL_TEXTURE_2D, 0);
+
+    // 4. Limpa
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+
+    // 5. Configura o VAO/VBO para renderizar texto
+    glGenVertexArrays(1, &textVAO);
+    glGenBuffers(1, &textVBO);
+    glState.bindVertexArray(textVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+    // 6 vértices (2 triângulos), cada vértice tem 4 floats (x, y, u, v)
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    // layout(location = 0) no text.vs
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.bindVertexArray(0);
+}
+
+void layoutText(const std::string &text, float x, float y, float scale, std::vector<GlyphQuad> &quads)
+{
+    quads.clear();
+    quads.reserve(text.size());
+
+    for (auto &c : text)
+    {
+        auto it = Characters.find(c);
+        if (it == Characters.end())
+            continue;
+        const Character &ch = it->second;
+
+        float xpos = x + ch.Bearing.x * scale;
+        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+
+        float w = ch.Size.x * scale;
+        float h = ch.Size.y * scale;
+
+        // Cada caractere: 2 triângulos (6 vértices)
+        quads.push_back(GlyphQuad{ch.TextureID,
+                                  {{xpos, ypos + h, 0.0f, 0.0f},
+                                   {xpos, ypos, 0.0f, 1.0f},
+                                   {xpos + w, ypos, 1.0f, 1.0f},
+
+                                   {xpos, ypos + h, 0.0f, 0.0f},
+                                   {xpos + w, ypos, 1.0f, 1.0f},
+                                   {xpos + w, ypos + h, 1.0f, 0.0f}}});
+
+        // Avança o "cursor"
+        x += (ch.Advance >> 6) * scale;
+        // (ch.Advance >> 6) converte de 1/64 em pixels
+    }
+}
+
+void RenderText(Shader &s, std::string text, float x, float y, float scale, glm::vec3 color)
+{
+    static std::vector<GlyphQuad> quads;
+    layoutText(text, x, y, scale, quads);
+
+    // Ativa o shader de texto
+    glState.useProgram(s.ID);
+    s.setVec3("textColor", color);
+    glState.bindVertexArray(textVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+
+    // Para cada caractere na string
+    for (auto &quad : quads)
+    {
+        // Render
+        glState.bindTexture(0, GL_TEXTURE_2D, quad.TextureID);
+        // Atualiza o buffer
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(quad.vertices), quad.vertices);
+
+        glState.drawArrays(GL_TRIANGLES, 0, 6);
+    }
+}
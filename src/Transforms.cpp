@@ -0,0 +1,52 @@
+#include "Transforms.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORMS_SSE 1
+#endif
+
+static void buildTransformRange(const glm::vec3 *positions, const uint32_t *indices, size_t begin, size_t end,
+                                const glm::mat4 &orientation, char *matrices, size_t stride)
+{
+    // translate(p) * M adds p * M[c].w to the xyz of every column c
+#ifdef TRANSFORMS_SSE
+    __m128 column[4], columnW[4];
+    for (int c = 0; c < 4; c++)
+    {
+        column[c] = _mm_loadu_ps(&orientation[c][0]);
+        columnW[c] = _mm_set1_ps(orientation[c][3]);
+    }
+#endif
+    for (size_t k = begin; k < end; k++)
+    {
+        const glm::vec3 &position = positions[indices ? indices[k] : k];
+        float *out = reinterpret_cast<float *>(matrices + k * stride);
+#ifdef TRANSFORMS_SSE
+        __m128 p = _mm_set_ps(0.0f, position.z, position.y, position.x);
+        for (int c = 0; c < 4; c++)
+            _mm_storeu_ps(out + 4 * c, _mm_add_ps(column[c], _mm_mul_ps(p, columnW[c])));
+#else
+        for (int c = 0; c < 4; c++)
+        {
+            float w = orientation[c][3];
+            out[4 * c + 0] = orientation[c][0] + position.x * w;
+            out[4 * c + 1] = orientation[c][1] + position.y * w;
+            out[4 * c + 2] = orientation[c][2] + position.z * w;
+            out[4 * c + 3] = w;
+        }
+#endif
+    }
+}
+
+void buildTransforms(const glm::vec3 *positions, const uint32_t *indices, size_t count, const glm::mat4 &orientation,
+                     void *matrices, size_t stride, JobSystem *jobs)
+{
+    char *out = static_cast<char *>(matrices);
+    if (!jobs || count <= TRANSFORM_BATCH)
+    {
+        buildTransformRange(positions, indices, 0, count, orientation, out, stride);
+        return;
+    }
+    jobs->parallelFor(count, TRANSFORM_BATCH, [&](size_t begin, size_t end)
+                      { buildTransformRange(positions, indices, begin, end, orientation, out, stride); });
+}
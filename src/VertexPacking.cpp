@@ -0,0 +1,101 @@
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+
+// half precision keeps about 1/1000 of a unit up to 2: a texel of a 1024 texture
+static const float MAX_PACKED_TEXCOORD = 2.0f;
+
+// an axis this much smaller than the largest would make the dequantize matrix (nearly) singular
+static const float MIN_RELATIVE_EXTENT = 1e-4f;
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) // infinity or NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    if (exponent >= 31) // too large: infinity
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    if (exponent <= 0)
+    {
+        // subnormal half (or zero)
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // round to nearest even; a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1)))
+        half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+uint32_t packSnorm10(const glm::vec3 &v)
+{
+    auto component = [](float c)
+    {
+        int value = static_cast<int>(std::lround(std::min(std::max(c, -1.0f), 1.0f) * 511.0f));
+        return static_cast<uint32_t>(value) & 0x3FFu;
+    };
+    return component(v.x) | (component(v.y) << 10) | (component(v.z) << 20);
+}
+
+bool canPackVertices(const std::vector<Vertex> &vertices, const BoundingBox &box)
+{
+    if (vertices.empty() || box.empty())
+        return false;
+
+    glm::vec3 extent = box.max - box.min;
+    float largest = std::max({extent.x, extent.y, extent.z});
+    if (std::min({extent.x, extent.y, extent.z}) <= largest * MIN_RELATIVE_EXTENT)
+        return false;
+
+    for (const Vertex &v : vertices)
+    {
+        if (std::fabs(v.TexCoords.x) > MAX_PACKED_TEXCOORD || std::fabs(v.TexCoords.y) > MAX_PACKED_TEXCOORD)
+            return false;
+    }
+    return true;
+}
+
+glm::mat4 packVertices(const std::vector<Vertex> &vertices, const BoundingBox &box, std::vector<PackedVertex> &packed)
+{
+    glm::vec3 extent = box.max - box.min;
+    glm::vec3 inverseExtent(1.0f / extent.x, 1.0f / extent.y, 1.0f / extent.z);
+
+    packed.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const Vertex &v = vertices[i];
+        PackedVertex &p = packed[i];
+
+        glm::vec3 unit = (v.Position - box.min) * inverseExtent;
+        for (int k = 0; k < 3; k++)
+            p.position[k] = static_cast<uint16_t>(std::lround(std::min(std::max(unit[k], 0.0f), 1.0f) * 65535.0f));
+        p.position[3] = 0;
+
+        // (model * dequantize)^-T applied to extent * n points along model^-T * n
+        glm::vec3 n = v.Normal * extent;
+        float length = glm::length(n);
+        p.normal = packSnorm10(length > 0.0f ? n * (1.0f / length) : n);
+
+        p.texCoords[0] = floatToHalf(v.TexCoords.x);
+        p.texCoords[1] = floatToHalf(v.TexCoords.y);
+    }
+
+    return glm::scale(glm::translate(glm::mat4(1.0f), box.min), extent);
+}
@@ -0,0 +1,3 @@
+// The only translation unit that compiles stb_image's implementation
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"